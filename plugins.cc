@@ -182,6 +182,14 @@ enum {
   //---------- Transform ------------------
 #define C_DIVBWT     C_LIBBSC //_TRANSFORM
  P_DIVBWT,
+#define C_SHUFFLE    1                                      // in-tree: transform_/ shuffle
+ P_SHUFFLE,
+ P_BITSHUFFLE,
+#define C_DELTA      1                                      // in-tree: transform_/ delta
+ P_DELTA,
+ P_DELTA2,
+ P_ZIGZAG,
+ P_XOR,
   // --------- Entropy coders -------------
  #if C_BCM  
 #define C_BCMEC     ECODER 
@@ -266,6 +274,7 @@ enum {
 #include <stdlib.h> 
 #include <string.h>
 #include <time.h>
+#include <stddef.h>
 #include "plugins.h"
 
   #if C_BALZ
@@ -390,6 +399,7 @@ class Out: public libzpaq::Writer {
   #if C_LZ4
 #include "lz4/lib/lz4.h"
 #include "lz4/lib/lz4hc.h"
+#include "lz4/lib/lz4frame.h"
   #endif
     
   #if C_LZ5
@@ -538,7 +548,9 @@ static const Lzma_options option_mapping[] =  {
   #endif  
 
   #if C_ZSTD
+#define ZSTD_STATIC_LINKING_ONLY
 #include "zstd/lib/common/zstd.h"
+#include "zstd/lib/dictBuilder/zdict.h"
   #endif
 
   #ifdef LZTURBO
@@ -573,6 +585,7 @@ extern "C" {
 typedef unsigned long mz_ulong;
 int mz_compress2(unsigned char *pDest, mz_ulong *pDest_len, const unsigned char *pSource, mz_ulong source_len, int level);
 int mz_uncompress(unsigned char *pDest, mz_ulong *pDest_len, const unsigned char *pSource, mz_ulong source_len);
+mz_ulong mz_compressBound(mz_ulong source_len);
   #endif
 
   #if C_SNAPPY_C
@@ -595,6 +608,12 @@ struct snappy_env env;
   #if C_DIVBWT 
 #include "libbsc/libbsc/bwt/divsufsort/divsufsort.h"
 #include "libbsc/libbsc/bwt/bwt.h"
+  #endif
+  #if C_SHUFFLE
+#include "transform_/shuffle.h"
+  #endif
+  #if C_DELTA
+#include "transform_/delta.h"
   #endif
   //------------------------------------ Entropy Coder ------------------------------
   #if C_FASTAC
@@ -680,7 +699,7 @@ extern "C" {
 }
   #endif
 //------------------------------------------------- registry -------------------------------------------------------------------------------------------------
-struct plugs plugs[] = {
+static struct plugs plugs_[] = {
   { P_BALZ, 	"balz", 			C_BALZ, 	"1.20",		"balz",					"Public Domain",	"http://sourceforge.net/projects/balz", 												"0,1" }, 
   { P_BCM, 		"bcm", 				C_BCM, 		"1.1b",		"bcm",					"Public Domain",	"https://github.com/encode84/bcm", 													"" }, 
   { P_C_BLOSC2, "blosc",			C_C_BLOSC2, "2.0",		"Blosc",				"BSD license",		"https://github.com/Blosc/c-blosc2", 													"0,1,2,3,4,5,6,7,8,9", 64*1024},
@@ -745,6 +764,7 @@ struct plugs plugs[] = {
 //-----------------------------------------------------------------------------------	  
   { P_MCPY, 	"imemcpy", 			C_MEMCPY, 	".",		"inline memcpy",		"------------",		"--------------------------------------",												"" },
   { P_LMCPY, 	"memcpy",			C_MEMCPY,  	".",		"library memcpy",		"",					"",																						"" },
+  { P_NULL, 	"null",				C_MEMCPY,  	".",		"null codec",			"",					"",																						"" },
   { P_BCMEC, 	"bcmec", 			C_BCMEC, 	"1.0",		"bcm range coder",		"Public Domain",	"http://sourceforge.net/projects/bcm",													"" },
   { P_FSC, 		"fsc", 				C_FSC, 		"15-05",	"Finite State Coder",	"Apache license",	"https://github.com/skal65535/fsc",														"", E_ANS },
   { P_FSE, 		"fse", 				C_FSE, 		"16-05",	"Finite State Entropy",	"BSD license",		"https://github.com/Cyan4973/FiniteStateEntropy",										"", E_ANS },
@@ -774,6 +794,12 @@ struct plugs plugs[] = {
   { P_RLET, 	"trle",	    		C_RLE, 	    "16-01", 	"TurboRLE",			    "            ",		"https://sites.google.com/site/powturbo",  												"" },
   //----- Transform -----
   { P_DIVBWT, 	"divbwt",    		C_DIVBWT,    "",		"bwt libdivsufsort/libbsc",	"        ",		"https://github.com/y-256/libdivsufsort",  												"" },
+  { P_SHUFFLE, 	"shuffle",    		C_SHUFFLE,   "",		"byte shuffle",			"            ",		"",  																					"0,1,2,4,8,16" },
+  { P_BITSHUFFLE,"bitshuffle",    	C_SHUFFLE,   "",		"bit shuffle",			"            ",		"",  																					"0,1,2,4,8,16" },
+  { P_DELTA, 	"delta",    		C_DELTA,     "",		"delta",				"            ",		"",  																					"8,16,32,64" },
+  { P_DELTA2, 	"delta2",    		C_DELTA,     "",		"delta of delta",		"            ",		"",  																					"8,16,32,64" },
+  { P_ZIGZAG, 	"zigzag",    		C_DELTA,     "",		"zigzag",				"            ",		"",  																					"8,16,32,64" },
+  { P_XOR, 		"xor",    			C_DELTA,     "",		"xor previous (Gorilla)","           ",		"",  																					"32,64,8,16" },
 
 //{ P_MYCODEC, 	"mycodec",			C_MYCODEC, 	"0",		"My codec",				"           ",		"",																						"" },
     #ifdef LZTURBO
@@ -781,11 +807,199 @@ struct plugs plugs[] = {
     #endif  
   { -1 }
 };
+struct plugs *plugs = plugs_;
+
+//---------------------------------------------- dynamic plugins (tbplug.h) ----------------------------------------------
+#include "tbplug.h"
+  #ifndef _WIN32
+#include <dlfcn.h>
+#include <dirent.h>
+#include <strings.h>
+  #endif
+#define PLUGDMAX 256
+static struct tbplug plugd[PLUGDMAX];                       // copies of the plugin entries, fields missing in older plugins are 0
+static int plugdn;
+
+static int plugdadd(const struct tbplug *pt, char *file) {
+  struct plugs *gs,*g; struct tbplug *t; int n,i; 
+  if(plugdn >= PLUGDMAX) { fprintf(stderr, "too many plugins '%s'\n", file); return -1; }
+  t = &plugd[plugdn]; memset(t, 0, sizeof(t[0]));
+  memcpy(t, pt, pt->size < sizeof(t[0])?pt->size:sizeof(t[0]));
+  if(t->abi > TBPLUG_ABI || pt->size < offsetof(struct tbplug, bound) || !t->name || !t->compress || !t->decompress) { fprintf(stderr, "invalid plugin '%s'\n", file); return -1; }
+  for(n = 0; plugs[n].id >= 0; n++); 
+  if(!(g = (struct plugs *)malloc((n+2)*sizeof(g[0])))) return -1;
+  memcpy(g, plugs, n*sizeof(g[0])); 
+  gs = &g[n]; memset(gs, 0, 2*sizeof(g[0]));
+  gs->id      = P_DYN+plugdn; 
+  gs->s       = (char *)t->name; 
+  for(i = 0; i < n; i++)                                    // same codec name in several .so: use the file name to select ex. a codec build
+    if(!strcasecmp(g[i].s, t->name)) { char *q = strrchr(file,'/'), *e; gs->s = strdup(q?q+1:file); if((e = strrchr(gs->s, '.'))) *e = 0; break; }
+  gs->codec   = 1;
+  gs->ver     = (char *)(t->version?t->version:"");
+  gs->name    = (char *)t->name;
+  gs->lic     = (char *)"plugin";
+  gs->url     = file;
+  gs->lev     = (char *)(t->levels?t->levels:"");
+  gs->flag    = t->flags; 
+  gs->blksize = t->blksize;
+  g[n+1].id   = -1;
+  if(plugs != plugs_) free(plugs); 
+  plugs = g; 
+  plugdn++;
+  return 0;
+}
+
+// load a codec plugin 'path' or all plugins (*.so) in directory 'path'. return number of codecs loaded
+int plugload(char *path) {
+    #ifdef _WIN32
+  fprintf(stderr, "dynamic plugins not supported\n"); return 0;
+    #else
+  DIR *dir; struct dirent *de; void *h; tbplug_get_t get; const struct tbplug *t; int n,i,c=0;
+  if((dir = opendir(path))) {
+    while((de = readdir(dir))) { 
+      char *q = strrchr(de->d_name, '.'), f[4096];
+      if(!q || strcmp(q, ".so")) continue;
+      snprintf(f, sizeof(f), "%s/%s", path, de->d_name);
+      c += plugload(f);
+    }
+    closedir(dir);
+    return c;
+  }
+  if(!(h = dlopen(path, RTLD_NOW|RTLD_LOCAL)))          { fprintf(stderr, "plugin: %s\n", dlerror()); return 0; }
+  if(!(get = (tbplug_get_t)dlsym(h, TBPLUG_GET)) || (n = get(TBPLUG_ABI, &t)) <= 0 || t->size < offsetof(struct tbplug, bound)) { fprintf(stderr, "plugin '%s': no '%s' or abi %d not supported\n", path, TBPLUG_GET, TBPLUG_ABI); dlclose(h); return 0; }
+  path = strdup(path);
+  for(i = 0; i < n; i++)                                    // entries are t->size bytes apart, also for plugins built with an older tbplug.h
+    if(!plugdadd((const struct tbplug *)((const char *)t + (size_t)i*t->size), path)) c++;
+  return c;
+    #endif
+}
 
 //---------------------------------------------- plugins --------------------------------------------------------
   #ifndef max
 #define max(x,y) (((x)>(y)) ? (x) : (y))
   #endif
+  #ifndef min
+#define min(x,y) (((x)<(y)) ? (x) : (y))
+  #endif
+
+//---------------------------------------------- allocators -----------------------------------------------------
+// Built-in allocators for the codecs accepting custom alloc functions (brotli, bzip2, lzma, zlib, zstd)
+// selected with the parameter 'a#' ex. "zstd,3a1" or globally with option -a#
+// 0:libc malloc, 1:bump arena reset per call, 2:size class pool, 3:huge page arena
+  #ifndef _WIN32
+#include <sys/mman.h>
+  #endif
+  
+#define BA_ARENASIZE (sizeof(void *) == 8?((size_t)1<<31):((size_t)1<<28))
+#define BA_CLASSMIN  4                                      // pool: size classes 16 bytes..64MB
+#define BA_CLASSMAX  26
+#define BA_HDR       16
+enum { BA_LIBC, BA_ARENA, BA_POOL, BA_HUGE };
+
+static int            balloc_type;
+static unsigned char *ba_arena, *ba_arenap, *ba_arenae;
+static void          *ba_pool[BA_CLASSMAX+1];
+
+static void ba_arenaini(int huge) {
+  if(ba_arena) _vfree(ba_arena, ba_arenae - ba_arena);
+  if(!(ba_arena = (unsigned char *)_valloc(BA_ARENASIZE, 4))) { fprintf(stderr, "arena alloc error\n"); exit(0); }
+    #ifdef MADV_HUGEPAGE
+  madvise(ba_arena, BA_ARENASIZE, huge?MADV_HUGEPAGE:MADV_NOHUGEPAGE);
+    #endif
+  ba_arenap = ba_arena; ba_arenae = ba_arena + BA_ARENASIZE;
+}
+
+// 1: codec accepts a custom allocator (-a# or parameter 'a#')
+int codballoc(int codec) {
+  switch(codec) {
+      #if C_BROTLI
+    case P_BROTLI:
+      #endif
+      #if C_BZIP2
+    case P_BZIP2:
+      #endif
+      #if C_LZMA
+    case P_LZMA:
+      #endif
+      #if C_ZLIB
+    case P_ZLIB:
+      #endif
+      #if C_ZSTD
+    case P_ZSTD:
+      #endif
+      return 1;
+  }
+  return 0;
+}
+
+void codalloc(int a) { 
+  if(a == balloc_type) return;
+  switch(balloc_type = a) {
+    case BA_ARENA: ba_arenaini(0); break;
+    case BA_HUGE:  ba_arenaini(1); break;
+  }
+}
+
+static inline void bareset(void) { 
+  if(ba_arenap > ba_arena) mem_sub(ba_arenap - ba_arena); 
+  ba_arenap = ba_arena; 
+}
+
+  #if C_BROTLI || C_BZIP2 || C_LZMA || C_ZLIB || C_ZSTD
+static void *balloc(size_t size) {
+  switch(balloc_type) {
+    case BA_ARENA:
+    case BA_HUGE: { 
+        size = (size + 63) & ~(size_t)63;
+        if(ba_arenap + size > ba_arenae) break;             // arena full: fallback to malloc
+        unsigned char *p = ba_arenap; ba_arenap += size; mem_add(size); 
+        return p; 
+      }
+    case BA_POOL: {
+        unsigned c; unsigned char *p;
+        for(c = BA_CLASSMIN; c <= BA_CLASSMAX && ((size_t)1<<c) < size+BA_HDR; c++);
+        if(c > BA_CLASSMAX) break;
+        if((p = (unsigned char *)ba_pool[c])) ba_pool[c] = *(void **)p;
+        else if(!(p = (unsigned char *)malloc((size_t)1<<c))) return NULL;
+        *(unsigned *)p = c;
+        return p + BA_HDR;
+      }
+  }
+  unsigned char *p = (unsigned char *)malloc(size+BA_HDR);
+  if(!p) return NULL;
+  *(unsigned *)p = 0;
+  return p + BA_HDR;
+}
+
+static void bfree(void *_p) {
+  unsigned char *p = (unsigned char *)_p;
+  if(!p || (p >= ba_arena && p < ba_arenae)) return;          // arena: freed by bareset
+  p -= BA_HDR;
+  unsigned c = *(unsigned *)p;
+  if(c) { *(void **)p = ba_pool[c]; ba_pool[c] = p; }
+  else free(p);
+}
+  #endif
+
+  #if C_BROTLI || C_LZMA || C_ZSTD
+static void *ba_alloc(void *opaque, size_t size) { return balloc(size); }
+static void  ba_free( void *opaque, void *p)     { bfree(p); }
+  #endif
+
+  #if C_LZMA
+static ISzAlloc g_BAlloc = { ba_alloc, ba_free };
+#define LZMA_ALLOC (balloc_type?&g_BAlloc:&g_Alloc)
+  #endif
+
+  #if C_ZLIB
+static voidpf ba_zalloc(voidpf opaque, uInt items, uInt size) { return balloc((size_t)items*size); }
+static void   ba_zfree( voidpf opaque, voidpf p)               { bfree(p); }
+  #endif
+
+  #if C_BZIP2
+static void  *ba_bzalloc(void *opaque, int items, int size)    { return balloc((size_t)items*size); }
+static void   ba_bzfree( void *opaque, void *p)                { bfree(p); }
+  #endif
 
 void libmemcpy(unsigned char *dst, unsigned char *src, int len) {
   void *(*memcpy_ptr)(void *, const void *, size_t) = memcpy;
@@ -798,8 +1012,143 @@ static char _workmem[1<<16],*workmem=_workmem;
 static int state_size,dstate_size;
 static size_t workmemsize;
 
+//---------------------------------------------- pipelines: codecs and transforms chained with '+' ---------------------------------
+// ex. "divbwt+rans_static_o1", "lz4:9+fse", "srle+zstd,3": stage level with ':', the levels/parameters of the pipeline apply to the last stage.
+// Block: 4 bytes input length of each stage except the first + output of the last stage. Decompression runs the stages in reverse.
+#define PIPEMAX  64
+#define PIPESTG  8
+struct pipe { 
+  int                n, id[PIPESTG], lev[PIPESTG]; 
+  char               prm[PIPESTG][33], *s[PIPESTG];
+  unsigned long long tc[PIPESTG], td[PIPESTG], ci[PIPESTG], co[PIPESTG], di[PIPESTG]; // per stage: time in ns, compression bytes in/out, decompression bytes out
+};
+static struct pipe    pipes[PIPEMAX];
+static int            pipen;
+static unsigned char *pipeb[2]; 
+static size_t         pipebsize;
+
+  #ifdef _WIN32
+#include <windows.h>
+static unsigned long long pipetime(void) { LARGE_INTEGER tm,f; QueryPerformanceCounter(&tm); QueryPerformanceFrequency(&f); return (unsigned long long)((double)tm.QuadPart*1e9/f.QuadPart); }
+  #else
+static unsigned long long pipetime(void) { struct timespec tm; clock_gettime(CLOCK_MONOTONIC, &tm); return (unsigned long long)tm.tv_sec*1000000000ull + tm.tv_nsec; }
+  #endif
+
+// register the pipeline 'name' as codec. return 0 or -1 on error
+int plugpipe(char *name) {
+  struct plugs *gs,*g,*gl = NULL; struct pipe *p; char s[256],*q,*t,*e; int n; unsigned flag = 0;
+  for(n = 0; plugs[n].id >= 0; n++) 
+    if(!strcasecmp(plugs[n].s, name)) return 0;
+  if(pipen >= PIPEMAX) { fprintf(stderr, "too many pipelines '%s'\n", name); return -1; }
+  if(strlen(name) >= sizeof(s)) { fprintf(stderr, "pipeline '%.32s...': name too long\n", name); return -1; }
+  p = &pipes[pipen]; memset(p, 0, sizeof(p[0]));
+  strcpy(s, name);
+  for(t = s; t && *t; t = e) {
+    if((e = strchr(t, '+'))) *e++ = 0;
+    if(p->n >= PIPESTG) { fprintf(stderr, "pipeline '%s': max. %d stages\n", name, PIPESTG); return -1; }
+    int lev = -1; char *prm = (char *)"";
+    if((q = strchr(t, ':'))) { *q++ = 0; lev = strtol(q, &prm, 10); }
+    for(gs = plugs; gs->id >= 0 && (!gs->codec || gs->id >= P_PIPE || strcasecmp(gs->s, t)); gs++);
+    if(gs->id < 0) { fprintf(stderr, "pipeline '%s': codec '%s' not found\n", name, t); return -1; }
+    if(!q && e && gs->lev && gs->lev[0]) lev = atoi(gs->lev); // inner stage w/o level: first level
+    p->id[p->n] = gs->id; p->lev[p->n] = lev; p->s[p->n] = gs->s; strncpy(p->prm[p->n], prm, 32); p->n++;
+    flag |= gs->flag; gl = gs;
+  }
+  if(!p->n) return -1;
+  for(n = 0; plugs[n].id >= 0; n++); 
+  if(!(g = (struct plugs *)malloc((n+2)*sizeof(g[0])))) return -1;
+  memcpy(g, plugs, n*sizeof(g[0])); 
+  gs = &g[n]; memset(gs, 0, 2*sizeof(g[0]));
+  gs->id      = P_PIPE+pipen; 
+  gs->s       = strdup(name);
+  gs->codec   = 1;
+  gs->ver     = (char *)"";
+  gs->name    = (char *)"pipeline";
+  gs->lic     = (char *)"";
+  gs->url     = (char *)"";
+  gs->lev     = (char *)(p->lev[p->n-1] < 0 && gl->lev?gl->lev:"");  // levels of the last stage
+  gs->flag    = flag;                                       // segment size of the most constrained stage (entropy coders)
+  gs->blksize = gl->blksize;
+  g[n+1].id   = -1;
+  if(plugs != plugs_) free(plugs); 
+  plugs = g;
+  pipen++;
+  return 0;
+}
+
+static int pipeini(size_t insize, struct pipe *p) {
+  size_t wm = 0, b; int i;
+  memset(p->tc, 0, sizeof(p->tc)); memset(p->td, 0, sizeof(p->td)); memset(p->ci, 0, sizeof(p->ci)); memset(p->co, 0, sizeof(p->co)); memset(p->di, 0, sizeof(p->di));
+  pipebsize = insize + insize/8 + (1<<16);
+  for(i = 0; i < p->n; i++) {                               // work memory shared by all stages
+    if((b = codbound(pipebsize, p->id[i]))) pipebsize = max(pipebsize, b);
+    codini(insize, p->id[i]); wm = max(wm, workmemsize);
+    if(workmem != _workmem) { free(workmem); workmem = _workmem; }
+  }
+  if((workmemsize = wm) > sizeof(_workmem) && !(workmem = (char *)malloc(wm))) { fprintf(stderr, "Malloc error: %zu\n", wm); exit(0); }
+  for(i = 0; i < 2; i++) if(!(pipeb[i] = (unsigned char *)malloc(pipebsize))) { fprintf(stderr, "Malloc error: %zu\n", pipebsize); exit(0); }
+  return 0;
+}
+
+static void pipeexit(struct pipe *p) {
+  int i;
+  for(i = 0; i < p->n; i++) codexit(p->id[i]);
+  for(i = 0; i < 2; i++) { free(pipeb[i]); pipeb[i] = NULL; }
+  workmem = _workmem;
+}
+
+static int pipecomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct pipe *p, int lev, char *prm) {
+  unsigned char *ip = in, *op = out + 4*(p->n-1), *ob; int il = inlen, s;
+  for(s = 0; s < p->n; s++) {
+    int last = s == p->n-1, os = last?(out+outsize) - op:pipebsize, l;
+    if(s) { unsigned u = il; memcpy(out+4*(s-1), &u, 4); }
+    ob = last?op:pipeb[s&1];
+    unsigned long long t = pipetime();
+    l = codcomp(ip, il, ob, os, p->id[s], last && lev >= 0?lev:p->lev[s], last && *prm?prm:p->prm[s]);
+    p->tc[s] += pipetime() - t; p->ci[s] += il; p->co[s] += l > 0?l:0;
+    if(l <= 0 || l > os) return 0;
+    ip = ob; il = l;
+  }
+  return 4*(p->n-1) + il;
+}
+
+static int pipedecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct pipe *p, int lev) {
+  unsigned char *ip = in + 4*(p->n-1), *ob; int il = inlen - 4*(p->n-1), s;
+  for(s = p->n-1; s >= 0; s--) {
+    unsigned u = outlen; if(s) memcpy(&u, in+4*(s-1), 4);
+    int ol = u;
+    if(s && u > pipebsize) return 0;
+    ob = s?pipeb[s&1]:out;
+    unsigned long long t = pipetime();
+    int l = coddecomp(ip, il, ob, ol, p->id[s], s == p->n-1 && lev >= 0?lev:p->lev[s]);
+    p->td[s] += pipetime() - t; p->di[s] += ol;
+    if(l <= 0) return 0;
+    ip = ob; il = ol;
+  }
+  return inlen;
+}
+
+// per stage results of the pipeline 'codec' since codini
+void codpipeprt(int codec, FILE *f) {
+  struct pipe *p; int s; unsigned long long tc = 0, td = 0;
+  if(codec < P_PIPE || codec >= P_PIPE+pipen) return;
+  p = &pipes[codec-P_PIPE];
+  for(s = 0; s < p->n; s++) { tc += p->tc[s]; td += p->td[s]; }
+  for(s = 0; s < p->n; s++) {
+    char name[64]; if(p->lev[s] >= 0) sprintf(name, "%s %d%s", p->s[s], p->lev[s], p->prm[s]); else sprintf(name, "%s%s", p->s[s], p->prm[s]);
+    fprintf(f, "  stage %d %-20s %6.1f%%  C %9.2f MB/s %5.1f%%  D %9.2f MB/s %5.1f%%\n", s+1, name, p->ci[s]?(double)p->co[s]*100.0/p->ci[s]:0.0,
+      p->tc[s]?(double)p->ci[s]*1000.0/p->tc[s]:0.0, tc?(double)p->tc[s]*100.0/tc:0.0,
+      p->td[s]?(double)p->di[s]*1000.0/p->td[s]:0.0, td?(double)p->td[s]*100.0/td:0.0); 
+  }
+}
+
+// 0: decoding uses shared state (pipeline buffers + stage stats, custom allocator arena/pool), no concurrent calls
+int codreent(int codec) { return codec < P_PIPE && !balloc_type; }
+
 int codini(size_t insize, int codec) {
   workmemsize = 0;
+  if(codec >= P_PIPE) return pipeini(insize, &pipes[codec-P_PIPE]);
+  if(codec >= P_DYN) return plugd[codec-P_DYN].init?plugd[codec-P_DYN].init(insize):0;
 
   switch(codec) {
       #if C_C_BLOSC2
@@ -868,12 +1217,15 @@ int codini(size_t insize, int codec) {
   }
   if(!workmemsize) return 0;
   if(workmemsize > sizeof(_workmem) && !(workmem = (char *)malloc(workmemsize)) ) { 
-    fprintf(stderr, "Malloc error: %d\n", workmemsize); 
+    fprintf(stderr, "Malloc error: %zu\n", workmemsize); 
     exit(0);
   }
+  return 0;
 }  
 
 void codexit(int codec) { 
+  if(codec >= P_PIPE) { pipeexit(&pipes[codec-P_PIPE]); return; }
+  if(codec >= P_DYN) { if(plugd[codec-P_DYN].exit) plugd[codec-P_DYN].exit(); return; }
   if(workmem != _workmem) {
     free(workmem/*, workmemsize*/); 
     workmem = NULL;
@@ -886,7 +1238,137 @@ void codexit(int codec) {
 
 int brotlidic,brotlictx,brotlirep;
 
-int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int codec, int lev, char *prm) {  int outlen; unsigned char *oend=out+outsize;
+//---------------------------------------------- codec functions ---------------------------------------------------------
+// shared by codcomp/coddecomp and the direct dispatch (codprmini). Parameters are parsed once into the codprm by codset
+  #if C_BROTLI
+static int brcomp( unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { size_t esize = outsize; int rc;
+  brotlidic = cp->p[2]&1; brotlirep = cp->p[2]&2; brotlictx = cp->p[2]&4;
+  if(balloc_type) { 
+    BrotliEncoderState *s = BrotliEncoderCreateInstance(ba_alloc, ba_free, NULL); if(!s) return 0;
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, cp->lev); BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, cp->p[0]); BrotliEncoderSetParameter(s, BROTLI_PARAM_MODE, cp->p[1]);
+    size_t ain = inlen; const uint8_t *ip = in; uint8_t *op = out; 
+    rc = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH, &ain, &ip, &esize, &op, NULL) && BrotliEncoderIsFinished(s);
+    BrotliEncoderDestroyInstance(s);                                                                           brotlidic = brotlictx = brotlirep = 0;
+    return rc?op-out:0;
+  }
+  rc = BrotliEncoderCompress(cp->lev, cp->p[0], (BrotliEncoderMode)cp->p[1], inlen, (uint8_t*)in, &esize, (uint8_t*)out); brotlidic = brotlictx = brotlirep = 0; 
+  return rc?esize:0; 
+}
+
+static int brdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { size_t dsize = outlen; 
+  if(balloc_type) { BrotliState *s = BrotliCreateState(ba_alloc, ba_free, NULL); if(!s) return 0;
+    size_t ain = inlen, tot = 0; const uint8_t *ip = in; uint8_t *op = out;
+    BrotliResult rc = BrotliDecompressStream(&ain, &ip, &dsize, &op, &tot, s); BrotliDestroyState(s); 
+    return rc == BROTLI_RESULT_SUCCESS?tot:0;
+  }
+  return BrotliDecompressBuffer(inlen, in, &dsize, out)?dsize:0; 
+}
+  #endif
+
+  #if C_LZ4
+static int lz4fcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return LZ4_compress_fast((char *)in, (char *)out, inlen, outsize, 4); }
+static int lz4comp( unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return LZ4_compress_default((char *)in, (char *)out, inlen, outsize); }
+static int lz4hcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return LZ4_compress_HC((char *)in, (char *)out, inlen, outsize, cp->lev); }
+static int lz4decomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { return LZ4_decompress_safe((const char *)in, (char *)out, inlen, outlen); }
+  #endif
+
+  #if C_LZMA
+    #ifdef __x86_64__
+#define DICSIZE (1<<30)
+    #else
+#define DICSIZE (1<<27)
+    #endif
+static int lzmacomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { CLzmaEncProps p; LzmaEncProps_Init(&p); p.level = cp->lev; p.numThreads = 1; 
+  if(cp->p[0] >= 0) p.lc = cp->p[0]; 
+  if(cp->p[1] >= 0) p.lp = cp->p[1];
+  if(cp->lev==9) p.fb = 273,p.dictSize=inlen<DICSIZE?inlen:DICSIZE; 
+  LzmaEncProps_Normalize(&p);
+  SizeT psize = LZMA_PROPS_SIZE, outlen = outsize - LZMA_PROPS_SIZE;
+  return LzmaEncode(out+LZMA_PROPS_SIZE, &outlen, in, inlen, &p, out, &psize, 0, NULL, LZMA_ALLOC, LZMA_ALLOC) == SZ_OK?outlen+LZMA_PROPS_SIZE:0;
+}
+
+static int lzmadecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  SizeT ol = outlen, il = inlen - LZMA_PROPS_SIZE; ELzmaStatus sts;
+  return LzmaDecode(out, &ol, in+LZMA_PROPS_SIZE, &il, in, LZMA_PROPS_SIZE, LZMA_FINISH_END, &sts, LZMA_ALLOC)?0:inlen;
+}
+  #endif
+
+  #if C_ZLIB
+static int zcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { 
+  if(balloc_type) { z_stream zs; memset(&zs, 0, sizeof(zs)); zs.zalloc = ba_zalloc; zs.zfree = ba_zfree;
+    if(deflateInit(&zs, cp->lev) != Z_OK) return 0;
+    zs.next_in = in; zs.avail_in = inlen; zs.next_out = out; zs.avail_out = outsize; 
+    int rc = deflate(&zs, Z_FINISH); deflateEnd(&zs); 
+    return rc == Z_STREAM_END?zs.total_out:0; 
+  }
+  uLongf outlen = outsize; 
+  return compress2(out, &outlen, in, inlen, cp->lev) == Z_OK?outlen:0; 
+}
+
+static int zdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp) { 
+  if(balloc_type) { z_stream zs; memset(&zs, 0, sizeof(zs)); zs.zalloc = ba_zalloc; zs.zfree = ba_zfree;
+    if(inflateInit(&zs) != Z_OK) return 0;
+    zs.next_in = in; zs.avail_in = inlen; zs.next_out = out; zs.avail_out = outlen; 
+    int rc = inflate(&zs, Z_FINISH); inflateEnd(&zs); 
+    return rc == Z_STREAM_END?outlen:0; 
+  }
+  uLongf l = outlen; 
+  return uncompress(out, &l, in, inlen) == Z_OK?l:0; 
+}
+  #endif
+
+  #if C_ZSTD
+static int zscomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { size_t rc;
+  if(balloc_type) { ZSTD_customMem cmem = { ba_alloc, ba_free, NULL }; ZSTD_CCtx *c = ZSTD_createCCtx_advanced(cmem); if(!c) return 0;
+    rc = ZSTD_compressCCtx(c, out, outsize, in, inlen, cp->lev); ZSTD_freeCCtx(c); 
+  } else rc = ZSTD_compress(out, outsize, in, inlen, cp->lev); 
+  return ZSTD_isError(rc)?0:rc; 
+}
+
+static int zsdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp) { size_t rc;
+  if(balloc_type) { ZSTD_customMem cmem = { ba_alloc, ba_free, NULL }; ZSTD_DCtx *d = ZSTD_createDCtx_advanced(cmem); if(!d) return 0;
+    rc = ZSTD_decompressDCtx(d, out, outlen, in, inlen); ZSTD_freeDCtx(d); 
+  } else rc = ZSTD_decompress(out, outlen, in, inlen); 
+  return ZSTD_isError(rc)?0:rc; 
+}
+  #endif
+
+// fill 'cp' with the codec functions + parsed parameters. return 0: codec not in the codec functions above
+static int codset(struct codprm *cp, int codec, int lev, char *prm) {
+  cp->codec = codec; cp->lev = lev; cp->prm = prm; 
+  switch(codec) {
+      #if C_BROTLI
+    case P_BROTLI: { char *q;
+      cp->p[0] = lev==11?24:22; if(strchr(prm,'w')) cp->p[0] = 22; else if(strchr(prm,'W')) cp->p[0] = 24;
+      cp->p[1] = (q = strchr(prm,'m'))?q[1]-'0':0; 
+      cp->p[2] = (strchr(prm,'D')?1:0) | (strchr(prm,'R')?2:0) | (strchr(prm,'X')?4:0);
+      cp->comp = brcomp; cp->decomp = brdecomp; return 1; }
+      #endif
+      #if C_LZ4
+    case P_LZ4: cp->comp = !lev?lz4fcomp:(lev<9?lz4comp:lz4hcomp); cp->decomp = lz4decomp; return 1;
+      #endif
+      #if C_LZMA
+    case P_LZMA: { char *q;
+      cp->p[0] = cp->p[1] = -1;
+      if((q = strchr(prm,'c'))) { cp->p[0] = q[1] - '0'; if(cp->p[0] <= 0) cp->p[0] = 0; if(cp->p[0] > 8) cp->p[0] = 8; }
+      if((q = strchr(prm,'p'))) { cp->p[1] = q[1] - '0'; if(cp->p[1] <= 0) cp->p[1] = 0; if(cp->p[1] > 4) cp->p[1] = 4; }
+      cp->comp = lzmacomp; cp->decomp = lzmadecomp; return 1; }
+      #endif
+      #if C_ZLIB
+    case P_ZLIB: cp->comp = zcomp;  cp->decomp = zdecomp;  return 1;
+      #endif
+      #if C_ZSTD
+    case P_ZSTD: cp->comp = zscomp; cp->decomp = zsdecomp; return 1;
+      #endif
+  }
+  return 0;
+}
+
+int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int codec, int lev, char *prm) {
+  if(codec >= P_PIPE) return pipecomp(in, inlen, out, outsize, &pipes[codec-P_PIPE], lev, prm);
+  if(codec >= P_DYN) return plugd[codec-P_DYN].compress(in, inlen, out, outsize, lev, prm);
+  if(balloc_type) bareset();
+  struct codprm cp; if(codset(&cp, codec, lev, prm)) return cp.comp(in, inlen, out, outsize, &cp);
   switch(codec) { 
       #ifdef LZTURBO  
     #include "../beplugc.c"
@@ -897,7 +1379,7 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
       #endif 
  
 	  #if C_BCM
-    case P_BCM: return bcmcompress(in, inlen, out); break;
+    case P_BCM: return bcmcompress(in, inlen, out);
       #endif 
 
       #if C_C_BLOSC2
@@ -913,15 +1395,6 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
 	case P_BRIEFLZ: return blz_pack(in, out, inlen, workmem);
 	  #endif
 	  
-      #if C_BROTLI
-    case P_BROTLI: { int lgwin,mode=0; char *q; if(q = strchr(prm,'m')) mode = *++q - '0';
-	    if(lev==11) lgwin = 24; if(strchr(prm,'w')) lgwin=22; else if(strchr(prm,'W')) lgwin=24; 			   if(strchr(prm,'D')) brotlidic++; if(strchr(prm,'R')) brotlirep++; if(strchr(prm,'X')) brotlictx++;
-        size_t esize = outsize; 
-        int rc = BrotliEncoderCompress(lev, lgwin, mode, inlen, (uint8_t*)in, &esize, (uint8_t*)out);          brotlidic = brotlictx = brotlirep = 0; 
-        return rc?esize:0; 
-      }
-	  #endif    
-
       #if C_LIBBSC
 	case P_LIBBSC_ST: return bsc_compress(in, out, inlen,                  0/*LZPHASHSIZE*/,  0/*LIBBSC_DEFAULT_LZPMINLEN*/,                  lev, lev>4?LIBBSC_CODER_QLFC_ADAPTIVE:LIBBSC_CODER_QLFC_STATIC, 0);
 	case P_LIBBSC:    return bsc_compress(in, out, inlen,/*18*/LIBBSC_DEFAULT_LZPHASHSIZE,/*32*/ LIBBSC_DEFAULT_LZPMINLEN, LIBBSC_BLOCKSORTER_BWT, lev,                                                       LIBBSC_DEFAULT_FEATURES);
@@ -929,13 +1402,20 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
 
 	  #if C_LIBDEFLATE
 	case P_LIBDEFLATE:  { struct deflate_compressor *dc = deflate_alloc_compressor(lev); 
-	   outlen = deflate_compress(dc,in, inlen,out, outsize); 
+	   int outlen = deflate_compress(dc,in, inlen,out, outsize); 
 	   deflate_free_compressor(dc); return outlen;
 	  } 
 	  #endif
 
       #if C_BZIP2
-	case P_BZIP2:    { unsigned outlen = outsize; return BZ2_bzBuffToBuffCompress((char *)out, &outlen, (char *)in, inlen, 9, 0, 0)==BZ_OK?outlen:-1; }
+	case P_BZIP2:    
+      if(balloc_type) { bz_stream bs; memset(&bs, 0, sizeof(bs)); bs.bzalloc = ba_bzalloc; bs.bzfree = ba_bzfree;
+        if(BZ2_bzCompressInit(&bs, 9, 0, 0) != BZ_OK) return -1;
+        bs.next_in = (char *)in; bs.avail_in = inlen; bs.next_out = (char *)out; bs.avail_out = outsize; 
+        int rc = BZ2_bzCompress(&bs, BZ_FINISH); BZ2_bzCompressEnd(&bs); 
+        return rc == BZ_STREAM_END?(int)bs.total_out_lo32:-1;
+      }
+      { unsigned outlen = outsize; return BZ2_bzBuffToBuffCompress((char *)out, &outlen, (char *)in, inlen, 9, 0, 0)==BZ_OK?outlen:-1; }
 	  #endif
 	  
 	  #if C_CHAMELEON
@@ -976,7 +1456,7 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
         util::compression::Compressor *c = util::compression::NewGipfeliCompressor();
         util::compression::UncheckedByteArraySink sink((char*) out);
         util::compression::ByteArraySource        src((const char*)in, inlen);
-        outlen = c->CompressStream(&src, &sink); delete c; return outlen;
+        int outlen = c->CompressStream(&src, &sink); delete c; return outlen;
 	  }	
 	  #endif
  
@@ -996,10 +1476,6 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
     case P_LIBZPAQ: { zin = in; zin_ = in+inlen; zout = out; char s[3]; s[0]=lev+'0'; s[1]=0; libzpaq::compress(&zmemin, &zmemout, s); return zout - out; }
       #endif
 
-	  #if C_LZ4
-    case P_LZ4: return !lev?LZ4_compress_fast((char *)in, (char *)out, inlen, outsize, 4):(lev<9?LZ4_compress_default((char *)in, (char *)out, inlen, outsize):LZ4_compress_HC((char *)in, (char *)out, inlen, outsize, lev));
-	  #endif
-
 	  #if C_LZ5
     case P_LZ5: return !lev?LZ5_compress_fast((char *)in, (char *)out, inlen, outsize, 4):(lev<2?LZ5_compress_default((char *)in, (char *)out, inlen, outsize):LZ5_compress_HC((char *)in, (char *)out, inlen, outsize, lev));
 	  #endif
@@ -1038,21 +1514,6 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
       }
       #endif
 		
-        #ifdef __x86_64__
-           #define DICSIZE (1<<30)
-        #else
-           #define DICSIZE (1<<27)
-        #endif
-      #if C_LZMA
-	case P_LZMA: { CLzmaEncProps p;	LzmaEncProps_Init(&p); p.level = lev; p.numThreads = 1; 
-	    char *q;  
-	    if(q=strchr(prm,'c')) { p.lc = *++q - '0'; if(p.lc <= 0) p.lc = 0; if(p.lc > 8) p.lc = 8; }
-	    if(q=strchr(prm,'p')) { p.lp = *++q - '0'; if(p.lp <= 0) p.lp = 0; if(p.lp > 4) p.lp = 4; }
-	    if(lev==9) p.fb = 273,p.dictSize=inlen<DICSIZE?inlen:DICSIZE; LzmaEncProps_Normalize(&p);
-        SizeT psize = LZMA_PROPS_SIZE, outlen = outsize - LZMA_PROPS_SIZE;
-  	    return LzmaEncode(out+LZMA_PROPS_SIZE, &outlen, in, inlen, &p, out, &psize, 0, NULL, &g_Alloc, &g_Alloc) == SZ_OK?outlen+LZMA_PROPS_SIZE:0;
-	  }
-      #endif
 	
       #if C_LZLIB
 	case P_LZLIB:  { unsigned outlen; bbcompress( (const uint8_t *)in, inlen, (uint8_t *)out, (int * const)&outlen,  option_mapping[lev].dictionary_size, option_mapping[lev].match_len_limit); return outlen; }
@@ -1105,11 +1566,11 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
 	  #endif
 
 	  #if C_LZSSE
-	case P_LZSSE2: {            LZSSE2_OptimalParseState *s = LZSSE2_MakeOptimalParseState(inlen); if(!s) return 0; outlen = LZSSE2_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE2_FreeOptimalParseState(s); return outlen; }
-	case P_LZSSE4: if(lev==0) { LZSSE4_FastParseState    *s = LZSSE4_MakeFastParseState();                          outlen = LZSSE4_CompressFast(         s, in, inlen, out, outsize      ); LZSSE4_FreeFastParseState(s);    return outlen; }
-                   else {       LZSSE4_OptimalParseState *s = LZSSE4_MakeOptimalParseState(inlen); if(!s) return 0; outlen = LZSSE4_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE4_FreeOptimalParseState(s); return outlen; }
-	case P_LZSSE8: if(lev==0) { LZSSE8_FastParseState    *s = LZSSE8_MakeFastParseState();                          outlen = LZSSE8_CompressFast(         s, in, inlen, out, outsize      ); LZSSE8_FreeFastParseState(s);    return outlen; }
-                   else {       LZSSE8_OptimalParseState *s = LZSSE8_MakeOptimalParseState(inlen); if(!s) return 0; outlen = LZSSE8_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE8_FreeOptimalParseState(s); return outlen; }
+	case P_LZSSE2: {            LZSSE2_OptimalParseState *s = LZSSE2_MakeOptimalParseState(inlen); if(!s) return 0; int outlen = LZSSE2_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE2_FreeOptimalParseState(s); return outlen; }
+	case P_LZSSE4: if(lev==0) { LZSSE4_FastParseState    *s = LZSSE4_MakeFastParseState();                          int outlen = LZSSE4_CompressFast(         s, in, inlen, out, outsize      ); LZSSE4_FreeFastParseState(s);    return outlen; }
+                   else {       LZSSE4_OptimalParseState *s = LZSSE4_MakeOptimalParseState(inlen); if(!s) return 0; int outlen = LZSSE4_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE4_FreeOptimalParseState(s); return outlen; }
+	case P_LZSSE8: if(lev==0) { LZSSE8_FastParseState    *s = LZSSE8_MakeFastParseState();                          int outlen = LZSSE8_CompressFast(         s, in, inlen, out, outsize      ); LZSSE8_FreeFastParseState(s);    return outlen; }
+                   else {       LZSSE8_OptimalParseState *s = LZSSE8_MakeOptimalParseState(inlen); if(!s) return 0; int outlen = LZSSE8_CompressOptimalParse( s, in, inlen, out, outsize, lev ); LZSSE8_FreeOptimalParseState(s); return outlen; }
 
 	  #endif
 
@@ -1193,9 +1654,6 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
     case P_YAPPY:    return YappyCompress(in, out, inlen, 10)-out;
 	  #endif
 
-      #if C_ZLIB
-    case P_ZLIB:     { uLongf outlen = outsize; int rc = compress2(out, &outlen, in, inlen, lev); if(rc != Z_OK) printf("zlib compress2 rc=%d\n", rc);	return outlen; }
-      #endif
 	  
       #if C_ZLING
     case P_ZLING:    return zling_compress(lev, in, inlen, out, outsize);
@@ -1211,9 +1669,6 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
 	 }
       #endif	    
 
-	  #if C_ZSTD
-    case P_ZSTD: ZSTD_compress( out, outsize, in, inlen, lev); break;
-      #endif   
     //------------------------- Encoding
      #if C_RLE 
           #define _ESC8  0x5 //0xda  
@@ -1235,10 +1690,25 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
     case P_DIVBWT: { int *sa = (int *)malloc((inlen + 1) * sizeof(int)); if(!sa) return -1; 
 	  unsigned bwtidx = divbwt(in, out+sizeof(bwtidx), sa, inlen, NULL, NULL, 0); free(sa); *(unsigned *)out = bwtidx; return inlen+4; }
       #endif	
+      #if C_SHUFFLE                                         // level: element size, 0: auto detect. 1 byte header: element size
+    case P_SHUFFLE:    *out = lev?lev:trstride(in, inlen, 32); trshuf(   in, inlen, out+1, *out); return inlen+1;
+    case P_BITSHUFFLE: *out = lev?lev:trstride(in, inlen, 32); trbitshuf(in, inlen, out+1, *out); return inlen+1;
+      #endif
+      #if C_DELTA                                           // level: element width in bits 8,16,32,64
+    case P_DELTA: case P_DELTA2: case P_ZIGZAG: case P_XOR:
+      if(lev != 8 && lev != 16 && lev != 32 && lev != 64) return 0;
+      switch(codec) {
+        case P_DELTA:  trdelta( in, inlen, out, lev); break;
+        case P_DELTA2: trdelta2(in, inlen, out, lev); break;
+        case P_ZIGZAG: trzigzag(in, inlen, out, lev); break;
+        case P_XOR:    trxor(   in, inlen, out, lev); break;
+      } return inlen;
+      #endif
     //------------------------- Entropy Coders -------------------------
       #if C_MEMCPY 
     case P_MCPY:   memcpy(out, in, inlen);    return inlen;
     case P_LMCPY:   libmemcpy(out, in, inlen); return inlen;
+    case P_NULL:   return inlen;
 	  #endif	
 
       #if C_BCMEC
@@ -1339,11 +1809,16 @@ int codcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int c
 //   case P_MYCODEC:   return mycomp(in, inlen, out, outsize);
 	  #endif	
  
-    defaulf: fprintf(stderr, "library '%d' not included\n", codec);
+    default: fprintf(stderr, "library '%d' not included\n", codec);
   } 
+  return 0;
 } 
   
 int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int codec, int lev) {	
+  if(codec >= P_PIPE) return pipedecomp(in, inlen, out, outlen, &pipes[codec-P_PIPE], lev);
+  if(codec >= P_DYN) return plugd[codec-P_DYN].decompress(in, inlen, out, outlen, lev);
+  if(balloc_type) bareset();
+  struct codprm cp; if(codset(&cp, codec, lev, (char *)"")) return cp.decomp(in, inlen, out, outlen, &cp);
   switch(codec) {
       #ifdef LZTURBO  
     #include "../beplugd.c"
@@ -1369,10 +1844,6 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
 	case P_BRIEFLZ:     return blz_depack(in, out, outlen);
 	  #endif
 	  
-      #if C_BROTLI
-    case P_BROTLI: { size_t dsize = outlen; int rc = BrotliDecompressBuffer(inlen,in,&dsize,out); return rc?dsize:0; }
-	  #endif
-
       #if C_LIBBSC
 	case P_LIBBSC_ST: 
 	case P_LIBBSC:	   return bsc_decompress(in, inlen, out, outlen, 0);
@@ -1386,7 +1857,14 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
 	  #endif
 
       #if C_BZIP2 	  
- 	case P_BZIP2: { unsigned outsize = outlen; return BZ2_bzBuffToBuffDecompress((char *)out, &outsize, (char *)in, inlen, 0, 0)==BZ_OK?outlen:-1; }
+ 	case P_BZIP2: 
+      if(balloc_type) { bz_stream bs; memset(&bs, 0, sizeof(bs)); bs.bzalloc = ba_bzalloc; bs.bzfree = ba_bzfree;
+        if(BZ2_bzDecompressInit(&bs, 0, 0) != BZ_OK) return -1;
+        bs.next_in = (char *)in; bs.avail_in = inlen; bs.next_out = (char *)out; bs.avail_out = outlen;
+        int rc = BZ2_bzDecompress(&bs); BZ2_bzDecompressEnd(&bs); 
+        return rc == BZ_STREAM_END?outlen:-1;
+      }
+      { unsigned outsize = outlen; return BZ2_bzBuffToBuffDecompress((char *)out, &outsize, (char *)in, inlen, 0, 0)==BZ_OK?outlen:-1; }
       #endif
 	  
 	  #if C_CHAMELEON
@@ -1445,9 +1923,6 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
     case P_LIBLZF: lzf_decompress(in, inlen, out, outlen); break;
 	  #endif
 
-	  #if C_LZ4
-    case P_LZ4: LZ4_decompress_safe((const char *)in, (char *)out, inlen, outlen); break;
-      #endif
 	  
 	  #if C_LZ5
     case P_LZ5: LZ5_decompress_safe((const char *)in, (char *)out, inlen, outlen); break;
@@ -1485,12 +1960,6 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
 	case P_LZLIB: { int out_len = outlen; bbdecompress( in, outlen, out, &out_len ); } break;
       #endif 
 	  
-	  #if C_LZMA
-	case P_LZMA: {  
-	    SizeT ol = outlen, il = inlen - LZMA_PROPS_SIZE; ELzmaStatus sts;
-	    return LzmaDecode(out, &ol, in+LZMA_PROPS_SIZE, &il, in, LZMA_PROPS_SIZE, LZMA_FINISH_END, &sts, &g_Alloc)?0:inlen;
-      }
-      #endif
 
 	  #if C_LZMAT
 	case P_LZMAT:  { MP_U32 rc = outlen; lzmat_decode(out, &rc, in, inlen); return rc; }  
@@ -1608,12 +2077,9 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
       #endif
 		 
       #if C_ZLIB
-    case P_ZLIB: case P_ZOPFLI: { uLongf outsize = outlen; int rc = uncompress(out, &outsize, in, inlen); } break;
+    case P_ZOPFLI: return zdecomp(in, inlen, out, outlen, NULL);
       #endif
 
-      #if C_ZSTD
-    case P_ZSTD: ZSTD_decompress( out, outlen, in, inlen); break;
-      #endif
       //------------ Encoding -----------------------------------------------------------------------
       #if C_RLE
     case P_RLES:
@@ -1630,10 +2096,25 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
       #if C_DIVBWT
     case P_DIVBWT: memcpy(out, in+4, outlen); bsc_bwt_decode(out, outlen, *(unsigned *)in, 0, NULL, 0); return inlen;
       #endif	
+      #if C_SHUFFLE
+    case P_SHUFFLE:    trunshuf(   in+1, outlen, out, *in); return inlen;
+    case P_BITSHUFFLE: trbitunshuf(in+1, outlen, out, *in); return inlen;
+      #endif
+      #if C_DELTA
+    case P_DELTA: case P_DELTA2: case P_ZIGZAG: case P_XOR:
+      if(lev != 8 && lev != 16 && lev != 32 && lev != 64) return 0;
+      switch(codec) {
+        case P_DELTA:  trundelta( in, outlen, out, lev); break;
+        case P_DELTA2: trundelta2(in, outlen, out, lev); break;
+        case P_ZIGZAG: trunzigzag(in, outlen, out, lev); break;
+        case P_XOR:    trunxor(   in, outlen, out, lev); break;
+      } return inlen;
+      #endif
       //------------ Entropy Coders ------------------------------------------------------------------
       #if C_MEMCPY 
     case P_MCPY:    memcpy(out, in, inlen); 	break;
     case P_LMCPY:   libmemcpy(out, in, outlen); break;
+    case P_NULL:    break;
       #endif
 
       #if C_BCMEC
@@ -1735,6 +2216,476 @@ int coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int
 //   case P_MYCODEC:   return mydecomp(in, inlen, out, outlen);
 	  #endif	
   }
+  return outlen;
+}
+
+// worst case compressed length (0 = unknown) for sizing the output buffer and the block expansion check
+size_t codbound(size_t inlen, int codec) {
+  if(codec >= P_PIPE) {                                     // stage bounds composed + stage lengths header, 0: a stage without bound
+    struct pipe *p = &pipes[codec-P_PIPE]; int s;
+    for(s = 0; s < p->n && inlen; s++) inlen = codbound(inlen, p->id[s]);
+    return inlen?inlen + 4*(p->n-1):0;
+  }
+  if(codec >= P_DYN) return plugd[codec-P_DYN].bound?plugd[codec-P_DYN].bound(inlen):0;
+  switch(codec) {
+      #if C_C_BLOSC2
+    case P_C_BLOSC2:   return inlen + BLOSC_MAX_OVERHEAD;
+      #endif
+      #if C_BROTLI
+    case P_BROTLI:     return inlen + 4*(inlen >> 14) + 6;  // uncompressed meta-blocks
+      #endif
+      #if C_BZIP2
+    case P_BZIP2:      return inlen + inlen/100 + 600;
+      #endif
+      #if C_FASTLZ
+    case P_FASTLZ:     return max(inlen + inlen/20, 66);
+      #endif
+      #if C_LZ4
+    case P_LZ4:        return LZ4_compressBound(inlen);
+      #endif
+      #if C_LZ5
+    case P_LZ5:        return LZ5_compressBound(inlen);
+      #endif
+      #if C_LZMA
+    case P_LZMA:       return inlen + inlen/3 + 128 + LZMA_PROPS_SIZE;
+      #endif
+      #if C_LZO
+    case P_LZO1b: case P_LZO1c: case P_LZO1f: case P_LZO1x: case P_LZO1y: case P_LZO1z: case P_LZO2a: 
+                       return inlen + inlen/16 + 64 + 3;
+      #endif
+      #if C_MINIZ
+    case P_MINIZ:      return mz_compressBound(inlen);
+      #endif
+      #if C_QUICKLZ
+    case P_QUICKLZ:    return inlen + 400;
+      #endif
+      #if C_SNAPPY
+    case P_SNAPPY:     return snappy::MaxCompressedLength(inlen);
+      #endif
+      #if C_SNAPPY_C
+    case P_SNAPPY_C:   return snappy_max_compressed_length(inlen);
+      #endif
+      #if C_ZLIB
+    case P_ZLIB:       
+    case P_ZOPFLI:     return compressBound(inlen);
+      #endif
+      #if C_ZSTD
+    case P_ZSTD:       return ZSTD_compressBound(inlen);
+      #endif
+      #if C_DIVBWT
+    case P_DIVBWT:     return inlen + 4;
+      #endif
+      #if C_SHUFFLE
+    case P_SHUFFLE: 
+    case P_BITSHUFFLE: return inlen + 1;
+      #endif
+      #if C_DELTA
+    case P_DELTA: case P_DELTA2: case P_ZIGZAG: case P_XOR: return inlen;
+      #endif
+      #if C_MEMCPY 
+    case P_MCPY: 
+    case P_LMCPY:
+    case P_NULL:       return inlen;
+      #endif
+      #if C_FSE
+    case P_FSE:        return max(FSE_compressBound(inlen), inlen);
+    case P_FSEH:       return max(HUF_compressBound(inlen), inlen);
+      #endif
+  }
+  return 0;
+}
+
+//---------------------------------------------- direct dispatch -----------------------------------------------------------
+// codec, level and parameters resolved once per benchmark into a function + prebuilt parameters (no switch/parsing per block)
+static int gcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return codcomp(  in, inlen, out, outsize, cp->codec, cp->lev, cp->prm); }
+static int gdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp) { return coddecomp(in, inlen, out, outlen,  cp->codec, cp->lev); }
+
+static int ncomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return inlen; }
+static int ndecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp) { return outlen; }
+
+static int pcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { return ((const struct tbplug *)cp->ctx)->compress(  in, inlen, out, outsize, cp->lev, cp->prm); }
+static int pdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp) { return ((const struct tbplug *)cp->ctx)->decompress(in, inlen, out, outlen,  cp->lev); }
+
+  #if C_MEMCPY
+static int mcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { memcpy(out, in, inlen); return inlen; }
+static int lmcomp( unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { libmemcpy(out, in, inlen); return inlen; }
+  #endif
+
+//------------------------------------- streaming API: chunked input/output + flush (parameter 's') ------------------------------
+static unsigned strm_in = 1<<16, strm_out = 1<<16; static int strm_flush;  // flush after each input chunk: 0=none 1=sync 2=full
+void codstrm(unsigned inchunk, unsigned outchunk, int flush) { if(inchunk) strm_in = inchunk; if(outchunk) strm_out = outchunk; strm_flush = flush; }
+#define SCHUNK(_p_,_e_,_n_) ((size_t)((_e_)-(_p_)) < (size_t)(_n_)?(size_t)((_e_)-(_p_)):(size_t)(_n_))
+
+  #if C_ZLIB
+static int zstrmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outsize; z_stream zs; int rc, fl; 
+  memset(&zs, 0, sizeof(zs)); if(deflateInit(&zs, cp->lev) != Z_OK) return 0;
+  do {
+    zs.next_in = ip; zs.avail_in = SCHUNK(ip, ie, strm_in); ip += zs.avail_in;
+    fl = ip >= ie?Z_FINISH:(strm_flush>1?Z_FULL_FLUSH:(strm_flush?Z_SYNC_FLUSH:Z_NO_FLUSH));
+    do {
+      zs.next_out = op; if(!(zs.avail_out = SCHUNK(op, oe, strm_out))) { deflateEnd(&zs); return 0; }
+      rc = deflate(&zs, fl); op = zs.next_out;
+    } while(zs.avail_out == 0 && rc != Z_STREAM_END);
+  } while(fl != Z_FINISH);
+  deflateEnd(&zs); 
+  return rc == Z_STREAM_END?op - out:0;
+}
+
+static int zstrmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outlen; z_stream zs; int rc;
+  memset(&zs, 0, sizeof(zs)); if(inflateInit(&zs) != Z_OK) return 0;
+  for(;;) {
+    if(!zs.avail_in) { if(ip >= ie) break; zs.next_in = ip; zs.avail_in = SCHUNK(ip, ie, strm_in); ip += zs.avail_in; }
+    zs.next_out = op; if(!(zs.avail_out = SCHUNK(op, oe, strm_out))) break;
+    rc = inflate(&zs, Z_NO_FLUSH); op = zs.next_out;
+    if(rc != Z_OK && rc != Z_BUF_ERROR) break;
+  }
+  inflateEnd(&zs);
+  return op - out;
+}
+  #endif
+
+  #if C_ZSTD
+static int zsstrmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outsize; size_t r; 
+  ZSTD_CStream *zc = ZSTD_createCStream(); if(!zc) return 0;
+  if(ZSTD_isError(ZSTD_initCStream(zc, cp->lev))) goto e;
+  do {
+    ZSTD_inBuffer ib = { ip, SCHUNK(ip, ie, strm_in), 0 }; ip += ib.size;
+    while(ib.pos < ib.size) { 
+      ZSTD_outBuffer ob = { op, SCHUNK(op, oe, strm_out), 0 }; if(!ob.size) goto e;
+      r = ZSTD_compressStream(zc, &ob, &ib); op += ob.pos; if(ZSTD_isError(r)) goto e; 
+    }
+    if(ip < ie && !strm_flush) continue;
+    do {                                                    // flush or end of frame
+      ZSTD_outBuffer ob = { op, SCHUNK(op, oe, strm_out), 0 }; if(!ob.size) goto e;
+      r = ip < ie?ZSTD_flushStream(zc, &ob):ZSTD_endStream(zc, &ob); op += ob.pos; if(ZSTD_isError(r)) goto e; 
+    } while(r);
+  } while(ip < ie);
+  ZSTD_freeCStream(zc);
+  return op - out;
+  e:ZSTD_freeCStream(zc);
+  return 0;
+}
+
+static int zsstrmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outlen;
+  ZSTD_DStream *zd = ZSTD_createDStream(); if(!zd) return 0;
+  ZSTD_inBuffer ib = { in, 0, 0 };
+  if(!ZSTD_isError(ZSTD_initDStream(zd))) 
+    for(;;) {
+      if(ib.pos == ib.size) { if(ip >= ie) break; ib.src = ip; ib.size = SCHUNK(ip, ie, strm_in); ib.pos = 0; ip += ib.size; }
+      ZSTD_outBuffer ob = { op, SCHUNK(op, oe, strm_out), 0 }; if(!ob.size) break;
+      size_t r = ZSTD_decompressStream(zd, &ob, &ib); op += ob.pos; 
+      if(ZSTD_isError(r) || !r) break;
+    }
+  ZSTD_freeDStream(zd);
+  return op - out;
+}
+  #endif
+
+  #if C_LZ4
+static int lz4strmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { // frame API: output of an update is not chunked
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outsize; size_t r; LZ4F_compressionContext_t c; LZ4F_preferences_t pr;
+  if(LZ4F_isError(LZ4F_createCompressionContext(&c, LZ4F_VERSION))) return 0;
+  memset(&pr, 0, sizeof(pr)); pr.compressionLevel = cp->lev;
+  if(LZ4F_isError(r = LZ4F_compressBegin(c, op, oe-op, &pr))) goto e; 
+  op += r;
+  while(ip < ie) {
+    size_t n = SCHUNK(ip, ie, strm_in);
+    if(LZ4F_isError(r = LZ4F_compressUpdate(c, op, oe-op, ip, n, NULL))) goto e; 
+    op += r; ip += n;
+    if(strm_flush && ip < ie) { if(LZ4F_isError(r = LZ4F_flush(c, op, oe-op, NULL))) goto e; op += r; }
+  }
+  if(LZ4F_isError(r = LZ4F_compressEnd(c, op, oe-op, NULL))) goto e; 
+  op += r;
+  LZ4F_freeCompressionContext(c);
+  return op - out;
+  e:LZ4F_freeCompressionContext(c);
+  return 0;
+}
+
+static int lz4strmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *ce = in, *op = out, *oe = out+outlen; LZ4F_decompressionContext_t d;
+  if(LZ4F_isError(LZ4F_createDecompressionContext(&d, LZ4F_VERSION))) return 0;
+  for(;;) {
+    if(ip >= ce) { if(ip >= ie) break; ce = ip + SCHUNK(ip, ie, strm_in); }
+    size_t on = SCHUNK(op, oe, strm_out), isz = ce - ip, r; if(!on) break;
+    r = LZ4F_decompress(d, op, &on, ip, &isz, NULL); ip += isz; op += on; 
+    if(LZ4F_isError(r) || !r) break;
+  }
+  LZ4F_freeDecompressionContext(d);
+  return op - out;
+}
+  #endif
+
+  #if C_BROTLI
+static int brstrmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { 
+  const uint8_t *ip = in, *ie = in+inlen; uint8_t *op = out, *oe = out+outsize; BrotliEncoderOperation o; int rc = 0; 
+  BrotliEncoderState *s = BrotliEncoderCreateInstance(NULL, NULL, NULL); if(!s) return 0;
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, cp->lev); BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, cp->p[0]); BrotliEncoderSetParameter(s, BROTLI_PARAM_MODE, cp->p[1]);
+  do {
+    size_t ain = SCHUNK(ip, ie, strm_in), aout; const uint8_t *cie = ip + ain;
+    o = cie >= ie?BROTLI_OPERATION_FINISH:(strm_flush?BROTLI_OPERATION_FLUSH:BROTLI_OPERATION_PROCESS);
+    do {
+      if(!(aout = SCHUNK(op, oe, strm_out))) goto e;
+      if(!BrotliEncoderCompressStream(s, o, &ain, &ip, &aout, &op, NULL)) goto e;
+    } while(ain || !aout || (o == BROTLI_OPERATION_FINISH && !BrotliEncoderIsFinished(s)));
+  } while(o != BROTLI_OPERATION_FINISH);
+  rc = op - out;
+  e:BrotliEncoderDestroyInstance(s);
+  return rc;
+}
+
+static int brstrmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  const uint8_t *ip = in, *ie = in+inlen; uint8_t *op = out, *oe = out+outlen; size_t ain = 0, aout, tot; 
+  BrotliState *s = BrotliCreateState(NULL, NULL, NULL); if(!s) return 0;
+  BrotliResult r = BROTLI_RESULT_NEEDS_MORE_INPUT;
+  while(r != BROTLI_RESULT_SUCCESS && r != BROTLI_RESULT_ERROR) {
+    if(!ain) { if(ip >= ie) break; ain = SCHUNK(ip, ie, strm_in); }
+    if(!(aout = SCHUNK(op, oe, strm_out))) break;
+    r = BrotliDecompressStream(&ain, &ip, &aout, &op, &tot, s);
+  }
+  BrotliDestroyState(s);
+  return op - out;
+}
+  #endif
+
+  #if C_LZMA
+struct lzstrm { ISeqInStream is; ISeqOutStream os; unsigned char *ip, *ie, *op, *oe; }; 
+static SRes lzsread(void *p, void *buf, size_t *size) {    // input callback: at most one input chunk per read
+  struct lzstrm *s = (struct lzstrm *)p; size_t n = SCHUNK(s->ip, s->ie, min(*size, strm_in)); 
+  memcpy(buf, s->ip, n); s->ip += n; *size = n; 
+  return SZ_OK; 
+}
+static size_t lzswrite(void *p, const void *buf, size_t size) { 
+  struct lzstrm *s = (struct lzstrm *)((char *)p - offsetof(struct lzstrm, os)); 
+  if(size > (size_t)(s->oe - s->op)) return 0; 
+  memcpy(s->op, buf, size); s->op += size; 
+  return size; 
+}
+
+static int lzmastrmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { // LzmaEnc: output chunks by the encoder, no flush
+  CLzmaEncProps p; LzmaEncProps_Init(&p); p.level = cp->lev; p.numThreads = 1; 
+  if(cp->p[0] >= 0) p.lc = cp->p[0]; 
+  if(cp->p[1] >= 0) p.lp = cp->p[1];
+  if(cp->lev==9) p.fb = 273,p.dictSize=inlen<DICSIZE?inlen:DICSIZE; 
+  LzmaEncProps_Normalize(&p);
+  CLzmaEncHandle e = LzmaEnc_Create(&g_Alloc); if(!e) return 0;
+  struct lzstrm s = { { lzsread }, { lzswrite }, in, in+inlen, out+LZMA_PROPS_SIZE, out+outsize };
+  SizeT psize = LZMA_PROPS_SIZE; 
+  SRes rc = LzmaEnc_SetProps(e, &p);
+  if(rc == SZ_OK) rc = LzmaEnc_WriteProperties(e, out, &psize);
+  if(rc == SZ_OK) rc = LzmaEnc_Encode(e, &s.os, &s.is, NULL, &g_Alloc, &g_Alloc);
+  LzmaEnc_Destroy(e, &g_Alloc, &g_Alloc);
+  return rc == SZ_OK?s.op - out:0;
+}
+
+static int lzmastrmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { // LzmaDec: incremental decoding
+  unsigned char *ip = in+LZMA_PROPS_SIZE, *ie = in+inlen, *op = out, *oe = out+outlen; CLzmaDec d; ELzmaStatus st; 
+  LzmaDec_Construct(&d); 
+  if(LzmaDec_Allocate(&d, in, LZMA_PROPS_SIZE, &g_Alloc) != SZ_OK) return 0;
+  LzmaDec_Init(&d);
+  while(op < oe) {
+    SizeT on = SCHUNK(op, oe, strm_out), isz = SCHUNK(ip, ie, strm_in);
+    if(LzmaDec_DecodeToBuf(&d, op, &on, ip, &isz, LZMA_FINISH_ANY, &st) != SZ_OK || (!on && !isz)) break;
+    ip += isz; op += on;
+  }
+  LzmaDec_Free(&d, &g_Alloc);
+  return op - out;
+}
+  #endif
+
+  #if C_BZIP2
+static int bzstrmcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outsize; bz_stream bs; int rc, a;
+  memset(&bs, 0, sizeof(bs)); if(BZ2_bzCompressInit(&bs, cp->lev > 0 && cp->lev <= 9?cp->lev:9, 0, 0) != BZ_OK) return 0;
+  do {
+    bs.next_in = (char *)ip; bs.avail_in = SCHUNK(ip, ie, strm_in); ip += bs.avail_in;
+    a = ip >= ie?BZ_FINISH:(strm_flush?BZ_FLUSH:BZ_RUN);
+    do {
+      bs.next_out = (char *)op; if(!(bs.avail_out = SCHUNK(op, oe, strm_out))) { BZ2_bzCompressEnd(&bs); return 0; }
+      rc = BZ2_bzCompress(&bs, a); op = (unsigned char *)bs.next_out;
+      if(rc < 0) { BZ2_bzCompressEnd(&bs); return 0; }
+    } while(a == BZ_RUN?bs.avail_in != 0:(a == BZ_FLUSH?rc == BZ_FLUSH_OK:rc != BZ_STREAM_END));
+  } while(a != BZ_FINISH);
+  BZ2_bzCompressEnd(&bs);
+  return op - out;
+}
+
+static int bzstrmdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, struct codprm *cp) { 
+  unsigned char *ip = in, *ie = in+inlen, *op = out, *oe = out+outlen; bz_stream bs; 
+  memset(&bs, 0, sizeof(bs)); if(BZ2_bzDecompressInit(&bs, 0, 0) != BZ_OK) return 0;
+  for(;;) {
+    if(!bs.avail_in) { if(ip >= ie) break; bs.next_in = (char *)ip; bs.avail_in = SCHUNK(ip, ie, strm_in); ip += bs.avail_in; }
+    bs.next_out = (char *)op; if(!(bs.avail_out = SCHUNK(op, oe, strm_out))) break;
+    int rc = BZ2_bzDecompress(&bs); op = (unsigned char *)bs.next_out;
+    if(rc != BZ_OK) break;
+  }
+  BZ2_bzDecompressEnd(&bs);
+  return op - out;
+}
+  #endif
+
+//------------------------------------- dictionary: training + per record de-/compression with a pre-digested dictionary ----------
+static const unsigned char *dictb; static size_t dictl;
+  #if C_ZSTD
+static ZSTD_CDict *zscdict; static ZSTD_DDict *zsddict; static ZSTD_CCtx *zscctx; static ZSTD_DCtx *zsdctx;
+  #endif
+  #if C_ZLIB
+static z_stream zdc, zdd;
+  #endif
+  #if C_LZ4
+static LZ4_stream_t lz4dict; static LZ4_streamHC_t lz4hcdict;
+  #endif
+
+// train a dictionary from n samples, return 0 when the codec has no trainer (raw prefix dictionary)
+size_t coddicttrain(int codec, unsigned char *dict, size_t dictcap, const unsigned char *samples, const size_t *sizes, unsigned n) {
+  switch(codec) {
+      #if C_ZSTD
+    case P_ZSTD: { size_t r = ZDICT_trainFromBuffer(dict, dictcap, samples, sizes, n); return ZDICT_isError(r)?0:r; }
+      #endif
+  }
+  return 0;
+}
+
+// digest the dictionary once per codec/level, return 0 when the codec has no dictionary support
+// dictlen=0: same reused contexts w/o dictionary (reference for the dictionary gain)
+int coddictini(int codec, int lev, const unsigned char *dict, size_t dictlen) {
+  dictb = dict; dictl = dictlen;
+  switch(codec) {
+      #if C_ZSTD
+    case P_ZSTD: 
+      if(dictlen) { zscdict = ZSTD_createCDict(dict, dictlen, lev); zsddict = ZSTD_createDDict(dict, dictlen); }
+      zscctx  = ZSTD_createCCtx(); zsdctx = ZSTD_createDCtx();
+      return (!dictlen || (zscdict && zsddict)) && zscctx && zsdctx;
+      #endif
+      #if C_ZLIB
+    case P_ZLIB: 
+      memset(&zdc, 0, sizeof(zdc)); memset(&zdd, 0, sizeof(zdd));
+      return deflateInit(&zdc, lev) == Z_OK && inflateInit(&zdd) == Z_OK;
+      #endif
+      #if C_LZ4
+    case P_LZ4: 
+      if(lev < 9) { memset(&lz4dict, 0, sizeof(lz4dict)); LZ4_loadDict(&lz4dict, (const char *)dict, dictlen); }
+      else { LZ4_resetStreamHC(&lz4hcdict, lev); LZ4_loadDictHC(&lz4hcdict, (const char *)dict, dictlen); }
+      return 1;
+      #endif
+      #if C_BROTLI
+    case P_BROTLI: return 1;
+      #endif
+  }
+  return 0;
+}
+
+void coddictexit(int codec) {
+  switch(codec) {
+      #if C_ZSTD
+    case P_ZSTD: ZSTD_freeCDict(zscdict); ZSTD_freeDDict(zsddict); ZSTD_freeCCtx(zscctx); ZSTD_freeDCtx(zsdctx); zscdict = NULL; zsddict = NULL; zscctx = NULL; zsdctx = NULL; break;
+      #endif
+      #if C_ZLIB
+    case P_ZLIB: deflateEnd(&zdc); inflateEnd(&zdd); break;
+      #endif
+  }
+  dictb = NULL; dictl = 0;
+}
+
+int coddictcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int codec, int lev) {
+  switch(codec) {
+      #if C_ZSTD
+    case P_ZSTD: { size_t r = dictl?ZSTD_compress_usingCDict(zscctx, out, outsize, in, inlen, zscdict):ZSTD_compressCCtx(zscctx, out, outsize, in, inlen, lev); return ZSTD_isError(r)?0:r; }
+      #endif
+      #if C_ZLIB
+    case P_ZLIB:                                            // zlib format with dictionary id: same framing as zlib w/o dictionary
+      deflateReset(&zdc); if(dictl) deflateSetDictionary(&zdc, dictb, dictl);
+      zdc.next_in = in; zdc.avail_in = inlen; zdc.next_out = out; zdc.avail_out = outsize;
+      return deflate(&zdc, Z_FINISH) == Z_STREAM_END?zdc.total_out:0;
+      #endif
+      #if C_LZ4
+    case P_LZ4:                                             // copy of the loaded stream state = pre-digested dictionary
+      if(lev < 9) { LZ4_stream_t s = lz4dict; return LZ4_compress_fast_continue(&s, (const char *)in, (char *)out, inlen, outsize, lev?1:4); }
+      else { static LZ4_streamHC_t s; s = lz4hcdict; return LZ4_compress_HC_continue(&s, (const char *)in, (char *)out, inlen, outsize); }
+      #endif
+      #if C_BROTLI
+    case P_BROTLI: { 
+        const uint8_t *ip = in; uint8_t *op = out; size_t ain = inlen, aout = outsize; 
+        BrotliEncoderState *s = BrotliEncoderCreateInstance(NULL, NULL, NULL); if(!s) return 0;
+        BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, lev); if(dictl) BrotliEncoderSetCustomDictionary(s, dictl, dictb);
+        int rc = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH, &ain, &ip, &aout, &op, NULL) && BrotliEncoderIsFinished(s);
+        BrotliEncoderDestroyInstance(s);
+        return rc?op - out:0;
+      }
+      #endif
+  }
+  return 0;
+}
+
+int coddictdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int codec, int lev) {
+  switch(codec) {
+      #if C_ZSTD
+    case P_ZSTD: { size_t r = dictl?ZSTD_decompress_usingDDict(zsdctx, out, outlen, in, inlen, zsddict):ZSTD_decompressDCtx(zsdctx, out, outlen, in, inlen); return ZSTD_isError(r)?0:r; }
+      #endif
+      #if C_ZLIB
+    case P_ZLIB: { int rc;
+        inflateReset(&zdd); zdd.next_in = in; zdd.avail_in = inlen; zdd.next_out = out; zdd.avail_out = outlen;
+        if((rc = inflate(&zdd, Z_FINISH)) == Z_NEED_DICT) { inflateSetDictionary(&zdd, dictb, dictl); rc = inflate(&zdd, Z_FINISH); }
+        return rc == Z_STREAM_END?zdd.total_out:0;
+      }
+      #endif
+      #if C_LZ4
+    case P_LZ4: return LZ4_decompress_safe_usingDict((const char *)in, (char *)out, inlen, outlen, (const char *)dictb, dictl);
+      #endif
+      #if C_BROTLI
+    case P_BROTLI: {
+        const uint8_t *ip = in; uint8_t *op = out; size_t ain = inlen, aout = outlen, tot; 
+        BrotliState *s = BrotliCreateState(NULL, NULL, NULL); if(!s) return 0;
+        if(dictl) BrotliSetCustomDictionary(dictl, dictb, s);
+        BrotliResult rc = BrotliDecompressStream(&ain, &ip, &aout, &op, &tot, s); 
+        BrotliDestroyState(s);
+        return rc == BROTLI_RESULT_SUCCESS?op - out:0;
+      }
+      #endif
+  }
+  return 0;
+}
+
+// return 1 for a direct path, 0 for the generic codcomp/coddecomp wrapper
+int codprmini(struct codprm *cp, int codec, int lev, char *prm) { int strm = prm && strchr(prm,'s');
+  memset(cp, 0, sizeof(cp[0]));
+  cp->codec = codec; cp->lev = lev; cp->prm = prm; 
+  cp->comp  = gcomp; cp->decomp = gdecomp;
+  if(codec >= P_PIPE) return 0;
+  if(codec >= P_DYN) { cp->ctx = &plugd[codec-P_DYN]; cp->comp = pcomp; cp->decomp = pdecomp; return 1; }
+  if(codec == P_NULL) { cp->comp = ncomp; cp->decomp = ndecomp; return 1; }
+  if(balloc_type && !strm) return 0;                        // custom allocators: reset per call in codcomp/coddecomp
+  if(codset(cp, codec, lev, prm) && !strm) return 1;
+  switch(codec) {
+      #if C_MEMCPY
+    case P_MCPY:  cp->comp = mcomp;  cp->decomp = mcomp;  return 1;
+    case P_LMCPY: cp->comp = lmcomp; cp->decomp = lmcomp; return 1;
+      #endif
+      //------------ streaming api (parameter 's'), parameters from codset
+      #if C_BROTLI
+    case P_BROTLI: cp->comp = brstrmcomp;   cp->decomp = brstrmdecomp;   return 1;
+      #endif
+      #if C_LZ4
+    case P_LZ4:    cp->comp = lz4strmcomp;  cp->decomp = lz4strmdecomp;  return 1;
+      #endif
+      #if C_LZMA
+    case P_LZMA:   cp->comp = lzmastrmcomp; cp->decomp = lzmastrmdecomp; return 1;
+      #endif
+      #if C_ZLIB
+    case P_ZLIB:   cp->comp = zstrmcomp;    cp->decomp = zstrmdecomp;    return 1;
+      #endif
+      #if C_ZSTD
+    case P_ZSTD:   cp->comp = zsstrmcomp;   cp->decomp = zsstrmdecomp;   return 1;
+      #endif
+      #if C_BZIP2
+    case P_BZIP2: if(strm) { cp->comp = bzstrmcomp; cp->decomp = bzstrmdecomp; return 1; } break;
+      #endif
+  }
+  return 0;
 }
 
 char *codver(int codec, char *v, char *s) {
@@ -33,18 +33,51 @@ struct plugs {
   unsigned flag,blksize; 
 };
 
+// codec ids: 0..P_NULL-1 built-in codecs (enum in plugins.cc), ids >= P_NULL are reserved for the harness
+#define P_NULL  1023                                        // null codec: no de-/compression, harness overhead per call
+#define P_DYN   1024                                        // id of the first loaded codec (tbplug.h), up to P_PIPE-1
+#define P_PIPE  2048                                        // id of the first pipeline (stage+stage)
+
+struct codprm;                                              // codec resolved once per benchmark, see codprmini
+typedef int (*codcomp_t)(  unsigned char *in, int inlen, unsigned char *out, int outsize, struct codprm *cp);
+typedef int (*coddecomp_t)(unsigned char *in, int inlen, unsigned char *out, int outlen,  struct codprm *cp);
+struct codprm { 
+  int         codec,lev; 
+  char       *prm; 
+  codcomp_t   comp; 
+  coddecomp_t decomp; 
+  int         p[4];                                         // parsed parameters
+  const void *ctx; 
+};
+
   #ifdef __cplusplus
 extern "C" {
   #endif
-extern struct plugs plugs[];
+extern struct plugs *plugs;
+int  plugload(char *path);
+int  plugpipe(char *name);
+void codpipeprt(int codec, FILE *f);
 int  codini(size_t insize, int codec);
 void codexit(int codec);
 int  codstart( unsigned char *in, int inlen, int codec);
 int  codcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, int codec, int lev, char *prm);
 int  coddecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  int codec, int lev);
 char *codver(int codec, char *v, char *s);
+size_t codbound(size_t inlen, int codec);
+int  codprmini(struct codprm *cp, int codec, int lev, char *prm);
+void codstrm(unsigned inchunk, unsigned outchunk, int flush);
+size_t coddicttrain(int codec, unsigned char *dict, size_t dictcap, const unsigned char *samples, const size_t *sizes, unsigned n);
+int  coddictini(int codec, int lev, const unsigned char *dict, size_t dictlen);
+int  coddictcomp(  unsigned char *in, int inlen, unsigned char *out, int outsize, int codec, int lev);
+int  coddictdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen,  int codec, int lev);
+void coddictexit(int codec);
 void *_valloc(size_t size, int a);
 void _vfree(void *p, size_t size);
+void codalloc(int a);
+int  codballoc(int codec);
+int  codreent(int codec);
+void mem_add(size_t size);
+void mem_sub(size_t size);
   #ifdef __cplusplus
 }
   #endif
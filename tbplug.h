@@ -0,0 +1,54 @@
+/**
+    Copyright (C) powturbo 2013-2016
+    GPL v2 License
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    - homepage : https://sites.google.com/site/powturbo/
+    - github   : https://github.com/powturbo
+    - twitter  : https://twitter.com/powturbo
+    - email    : powturbo [_AT_] gmail [_DOT_] com
+**/
+//	    TurboBench: tbplug.h - ABI for dynamically loaded codec plugins (turbobench -Xdir or -Xfile.so)
+// A shared object exports:  int tbplug_get(int abi, const struct tbplug **plugs);
+// returning the number of codecs in the array 'plugs' or 0 when 'abi' is not supported.
+// Only append new fields at the end and increment TBPLUG_ABI. turbobench accepts plugins with abi <= TBPLUG_ABI,
+// steps through 'plugs' by 'size' and sets the fields missing in older plugins to 0.
+#ifndef TBPLUG_H
+#define TBPLUG_H
+#include <stddef.h>
+
+#define TBPLUG_ABI 1
+#define TBPLUG_GET "tbplug_get"
+  #ifdef _WIN32
+#define TBPLUG_EXPORT __declspec(dllexport)
+  #else
+#define TBPLUG_EXPORT __attribute__((visibility("default")))  // plugins are built with -fvisibility=hidden (A/B builds)
+  #endif
+
+struct tbplug {
+  int         abi;                                          // TBPLUG_ABI
+  unsigned    size;                                         // sizeof(struct tbplug) of the plugin build
+  const char *name,*version,*levels;                        // codec name used in -e, version, levels ex. "1,2,3" or ""
+  unsigned    flags,blksize;                                // flags: E_ANS/E_HUF in plugins.h, default block size (0=file size)
+  int       (*init)(size_t insize);                         // optional: called before each file
+  int       (*compress)(  unsigned char *in, int inlen, unsigned char *out, int outsize, int lev, char *prm); // return compressed length, <= 0 on error
+  int       (*decompress)(unsigned char *in, int inlen, unsigned char *out, int outlen,  int lev);
+  size_t    (*bound)(size_t inlen);                         // optional: worst case compressed length
+  void      (*exit)(void);                                  // optional: called after each file
+};
+
+typedef int (*tbplug_get_t)(int abi, const struct tbplug **plugs);
+#endif
@@ -0,0 +1,33 @@
+//	    TurboBench: tbplug_/tbzlib.c - example codec plugin (see tbplug.h) using the installed zlib
+// make tbplug_/tbzlib.so
+// ./turbobench -Xtbplug_/tbzlib.so -etbzlib,1,6,9 file      or -Xtbplug_ for all plugins in the directory
+// A/B: make tbplug_/zlib_b.so ZLIB_B=path_to_other_zlib   ./turbobench -Xtbplug_/zlib_b.so -ezlib,1,6/zlib_b,1,6 -Dzlib:zlib_b file
+#include <zlib.h>
+#include "../tbplug.h"
+  #ifndef TBNAME
+#define TBNAME "tbzlib"
+  #endif
+
+static int zcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int lev, char *prm) {
+  uLongf outlen = outsize;
+  int rc = compress2(out, &outlen, in, inlen, lev);
+  return rc == Z_OK?outlen:0;
+}
+
+static int zdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int lev) {
+  uLongf l = outlen;
+  int rc = uncompress(out, &l, in, inlen);
+  return rc == Z_OK?inlen:0;
+}
+
+static size_t zbound(size_t inlen) { return compressBound(inlen); }
+
+static const struct tbplug zplug[] = {
+  { TBPLUG_ABI, sizeof(struct tbplug), TBNAME, ZLIB_VERSION, "1,2,3,4,5,6,7,8,9", 0, 0, 0, zcomp, zdecomp, zbound, 0 }
+};
+
+TBPLUG_EXPORT int tbplug_get(int abi, const struct tbplug **plugs) {
+  if(abi < TBPLUG_ABI) return 0;
+  *plugs = zplug;
+  return sizeof(zplug)/sizeof(zplug[0]);
+}
@@ -0,0 +1,31 @@
+//	    TurboBench: tbplug_/tbzstd.c - zstd codec plugin (see tbplug.h) for A/B builds
+// make tbplug_/zstd_b.so ZSTD_B=path_to_other_zstd   ./turbobench -Xtbplug_/zstd_b.so -ezstd,1,9/zstd_b,1,9 -Dzstd:zstd_b file
+#include "zstd.h"
+#include "../tbplug.h"
+  #ifndef TBNAME
+#define TBNAME "tbzstd"
+  #endif
+#define _STR(a) #a
+#define STR(a) _STR(a)
+
+static int zcomp(unsigned char *in, int inlen, unsigned char *out, int outsize, int lev, char *prm) {
+  size_t rc = ZSTD_compress(out, outsize, in, inlen, lev);
+  return ZSTD_isError(rc)?0:rc;
+}
+
+static int zdecomp(unsigned char *in, int inlen, unsigned char *out, int outlen, int lev) {
+  size_t rc = ZSTD_decompress(out, outlen, in, inlen);
+  return ZSTD_isError(rc)?0:rc;
+}
+
+static size_t zbound(size_t inlen) { return ZSTD_compressBound(inlen); }
+
+static const struct tbplug zplug[] = {
+  { TBPLUG_ABI, sizeof(struct tbplug), TBNAME, STR(ZSTD_VERSION_MAJOR) "." STR(ZSTD_VERSION_MINOR) "." STR(ZSTD_VERSION_RELEASE), "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,22", 0, 0, 0, zcomp, zdecomp, zbound, 0 }
+};
+
+TBPLUG_EXPORT int tbplug_get(int abi, const struct tbplug **plugs) {
+  if(abi < TBPLUG_ABI) return 0;
+  *plugs = zplug;
+  return sizeof(zplug)/sizeof(zplug[0]);
+}
@@ -0,0 +1,141 @@
+/**
+    Copyright (C) powturbo 2013-2016
+    GPL v2 License
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    - homepage : https://sites.google.com/site/powturbo/
+    - github   : https://github.com/powturbo
+    - twitter  : https://twitter.com/powturbo
+    - email    : powturbo [_AT_] gmail [_DOT_] com
+**/
+//	    TurboBench: transform_/delta.c - delta, delta of delta, zigzag, xor with previous
+// encode: previous elements shifted in from the last vector. decode: prefix sum/xor in log2(16/B) steps + last element of the previous vector
+#include <string.h>
+#include <stdint.h>
+#include "delta.h"
+
+  #if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TR_SSE2
+  #endif
+
+#define SUB_(a,b) ((a)-(b))
+#define ADD_(a,b) ((a)+(b))
+#define XOR_(a,b) ((a)^(b))
+
+  #ifdef TR_SSE2
+static inline __m128i bcast8( __m128i v) { v = _mm_unpacklo_epi8(_mm_srli_si128(v, 15), _mm_srli_si128(v, 15)); v = _mm_shufflelo_epi16(v, 0); return _mm_unpacklo_epi64(v, v); }
+static inline __m128i bcast16(__m128i v) { v = _mm_shufflehi_epi16(v, 0xff); return _mm_unpackhi_epi64(v, v); }
+static inline __m128i bcast32(__m128i v) { return _mm_shuffle_epi32(v, 0xff); }
+static inline __m128i bcast64(__m128i v) { return _mm_unpackhi_epi64(v, v); }
+
+// _t_: element type, _B_: bytes, _op_/_vop_: scalar/vector difference
+#define TR_ENC(_name_, _t_, _B_, _op_, _vop_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) {\
+  size_t i = 0; _t_ p = 0, x; __m128i pv = _mm_setzero_si128();\
+  for(; i + 16/_B_ <= m; i += 16/_B_) {\
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i*_B_));\
+    _mm_storeu_si128((__m128i *)(out + i*_B_), _vop_(v, _mm_or_si128(_mm_slli_si128(v, _B_), _mm_srli_si128(pv, 16-_B_))));\
+    pv = v;\
+  }\
+  if(i) { unsigned char t[16]; _mm_storeu_si128((__m128i *)t, pv); memcpy(&p, t + 16-_B_, _B_); }\
+  for(; i < m; i++) { memcpy(&x, in + i*_B_, _B_); _t_ y = _op_(x, p); memcpy(out + i*_B_, &y, _B_); p = x; }\
+}
+
+#define TR_DEC(_name_, _t_, _B_, _op_, _vop_, _bcast_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) {\
+  size_t i = 0; _t_ p = 0, x; __m128i pv = _mm_setzero_si128();\
+  for(; i + 16/_B_ <= m; i += 16/_B_) {\
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i*_B_));\
+    if(_B_ < 2) v = _vop_(v, _mm_slli_si128(v, 1));\
+    if(_B_ < 4) v = _vop_(v, _mm_slli_si128(v, 2));\
+    if(_B_ < 8) v = _vop_(v, _mm_slli_si128(v, 4));\
+    v = _vop_(v, _mm_slli_si128(v, 8));\
+    pv = _vop_(v, _bcast_(pv));\
+    _mm_storeu_si128((__m128i *)(out + i*_B_), pv);\
+  }\
+  if(i) { unsigned char t[16]; _mm_storeu_si128((__m128i *)t, pv); memcpy(&p, t + 16-_B_, _B_); }\
+  for(; i < m; i++) { memcpy(&x, in + i*_B_, _B_); p = _op_(x, p); memcpy(out + i*_B_, &p, _B_); }\
+}
+  #else
+#define TR_ENC(_name_, _t_, _B_, _op_, _vop_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) { size_t i; _t_ p = 0, x;\
+  for(i = 0; i < m; i++) { memcpy(&x, in + i*_B_, _B_); _t_ y = _op_(x, p); memcpy(out + i*_B_, &y, _B_); p = x; }\
+}
+#define TR_DEC(_name_, _t_, _B_, _op_, _vop_, _bcast_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) { size_t i; _t_ p = 0, x;\
+  for(i = 0; i < m; i++) { memcpy(&x, in + i*_B_, _B_); p = _op_(x, p); memcpy(out + i*_B_, &p, _B_); }\
+}
+  #endif
+
+TR_ENC(dlenc8,  uint8_t,  1, SUB_, _mm_sub_epi8)  TR_DEC(dldec8,  uint8_t,  1, ADD_, _mm_add_epi8,  bcast8)
+TR_ENC(dlenc16, uint16_t, 2, SUB_, _mm_sub_epi16) TR_DEC(dldec16, uint16_t, 2, ADD_, _mm_add_epi16, bcast16)
+TR_ENC(dlenc32, uint32_t, 4, SUB_, _mm_sub_epi32) TR_DEC(dldec32, uint32_t, 4, ADD_, _mm_add_epi32, bcast32)
+TR_ENC(dlenc64, uint64_t, 8, SUB_, _mm_sub_epi64) TR_DEC(dldec64, uint64_t, 8, ADD_, _mm_add_epi64, bcast64)
+TR_ENC(xrenc8,  uint8_t,  1, XOR_, _mm_xor_si128) TR_DEC(xrdec8,  uint8_t,  1, XOR_, _mm_xor_si128, bcast8)
+TR_ENC(xrenc16, uint16_t, 2, XOR_, _mm_xor_si128) TR_DEC(xrdec16, uint16_t, 2, XOR_, _mm_xor_si128, bcast16)
+TR_ENC(xrenc32, uint32_t, 4, XOR_, _mm_xor_si128) TR_DEC(xrdec32, uint32_t, 4, XOR_, _mm_xor_si128, bcast32)
+TR_ENC(xrenc64, uint64_t, 8, XOR_, _mm_xor_si128) TR_DEC(xrdec64, uint64_t, 8, XOR_, _mm_xor_si128, bcast64)
+
+//------------------------------------- zigzag ---------------------------------------------------------------------
+#define ZZENC(_t_, _s_, _x_) (((_t_)(_x_) << 1) ^ (_t_)((_s_)(_x_) >> (sizeof(_t_)*8-1)))
+#define ZZDEC(_t_, _x_)      (((_x_) >> 1) ^ (_t_)-(_t_)((_x_) & 1))
+
+  #ifdef TR_SSE2
+static inline __m128i zzenc8( __m128i v) { return _mm_xor_si128(_mm_add_epi8(v, v), _mm_cmpgt_epi8(_mm_setzero_si128(), v)); }
+static inline __m128i zzenc16(__m128i v) { return _mm_xor_si128(_mm_slli_epi16(v, 1), _mm_srai_epi16(v, 15)); }
+static inline __m128i zzenc32(__m128i v) { return _mm_xor_si128(_mm_slli_epi32(v, 1), _mm_srai_epi32(v, 31)); }
+static inline __m128i zzenc64(__m128i v) { return _mm_xor_si128(_mm_slli_epi64(v, 1), _mm_shuffle_epi32(_mm_srai_epi32(v, 31), 0xf5)); }
+static inline __m128i zzdec8( __m128i v) { return _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi8(0x7f)), _mm_sub_epi8( _mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi8(1)))); }
+static inline __m128i zzdec16(__m128i v) { return _mm_xor_si128(_mm_srli_epi16(v, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi16(1)))); }
+static inline __m128i zzdec32(__m128i v) { return _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi32(1)))); }
+static inline __m128i zzdec64(__m128i v) { return _mm_xor_si128(_mm_srli_epi64(v, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(v, _mm_set_epi32(0, 1, 0, 1)))); }
+#define TR_ZZ(_name_, _t_, _B_, _sc_, _vf_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) { size_t i = 0; _t_ x;\
+  for(; i + 16/_B_ <= m; i += 16/_B_) _mm_storeu_si128((__m128i *)(out + i*_B_), _vf_(_mm_loadu_si128((const __m128i *)(in + i*_B_))));\
+  for(; i < m; i++) { memcpy(&x, in + i*_B_, _B_); x = _sc_; memcpy(out + i*_B_, &x, _B_); }\
+}
+  #else
+#define TR_ZZ(_name_, _t_, _B_, _sc_, _vf_)\
+static void _name_(const unsigned char *in, size_t m, unsigned char *out) { size_t i; _t_ x;\
+  for(i = 0; i < m; i++) { memcpy(&x, in + i*_B_, _B_); x = _sc_; memcpy(out + i*_B_, &x, _B_); }\
+}
+  #endif
+
+TR_ZZ(zzenc8_,  uint8_t,  1, ZZENC(uint8_t,  int8_t,  x), zzenc8)  TR_ZZ(zzdec8_,  uint8_t,  1, ZZDEC(uint8_t,  x), zzdec8)
+TR_ZZ(zzenc16_, uint16_t, 2, ZZENC(uint16_t, int16_t, x), zzenc16) TR_ZZ(zzdec16_, uint16_t, 2, ZZDEC(uint16_t, x), zzdec16)
+TR_ZZ(zzenc32_, uint32_t, 4, ZZENC(uint32_t, int32_t, x), zzenc32) TR_ZZ(zzdec32_, uint32_t, 4, ZZDEC(uint32_t, x), zzdec32)
+TR_ZZ(zzenc64_, uint64_t, 8, ZZENC(uint64_t, int64_t, x), zzenc64) TR_ZZ(zzdec64_, uint64_t, 8, ZZDEC(uint64_t, x), zzdec64)
+
+//------------------------------------- API -------------------------------------------------------------------------
+typedef void (*trfunc_t)(const unsigned char *in, size_t m, unsigned char *out);
+
+static void trrun(trfunc_t f8, trfunc_t f16, trfunc_t f32, trfunc_t f64, const unsigned char *in, size_t n, unsigned char *out, unsigned w) {
+  unsigned b = w/8; size_t m;
+  switch(w) { case 8: break; case 16: f8 = f16; break; case 64: f8 = f64; break; default: f8 = f32; b = 4; }
+  m = n/b;
+  f8(in, m, out);
+  if(in != out) memcpy(out + m*b, in + m*b, n - m*b);
+}
+
+void trdelta(   const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(dlenc8,   dlenc16,   dlenc32,   dlenc64,   in,  n, out, w); }
+void trundelta( const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(dldec8,   dldec16,   dldec32,   dldec64,   in,  n, out, w); }
+void trdelta2(  const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trdelta(  in, n, out, w); trdelta(  out, n, out, w); }
+void trundelta2(const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trundelta(in, n, out, w); trundelta(out, n, out, w); }
+void trzigzag(  const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(zzenc8_,  zzenc16_,  zzenc32_,  zzenc64_,  in,  n, out, w); }
+void trunzigzag(const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(zzdec8_,  zzdec16_,  zzdec32_,  zzdec64_,  in,  n, out, w); }
+void trxor(     const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(xrenc8,   xrenc16,   xrenc32,   xrenc64,   in,  n, out, w); }
+void trunxor(   const unsigned char *in, size_t n, unsigned char *out, unsigned w) { trrun(xrdec8,   xrdec16,   xrdec32,   xrdec64,   in,  n, out, w); }
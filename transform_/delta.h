@@ -0,0 +1,42 @@
+/**
+    Copyright (C) powturbo 2013-2016
+    GPL v2 License
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    - homepage : https://sites.google.com/site/powturbo/
+    - github   : https://github.com/powturbo
+    - twitter  : https://twitter.com/powturbo
+    - email    : powturbo [_AT_] gmail [_DOT_] com
+**/
+//	    TurboBench: transform_/delta.h - delta, delta of delta, zigzag and xor with previous of 8/16/32/64 bits elements (SSE2 + scalar)
+// w: element width in bits. Little endian elements, remaining n%(w/8) bytes copied. in == out allowed
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stddef.h>
+
+void trdelta(    const unsigned char *in, size_t n, unsigned char *out, unsigned w); // x[i] - x[i-1]
+void trundelta(  const unsigned char *in, size_t n, unsigned char *out, unsigned w);
+void trdelta2(   const unsigned char *in, size_t n, unsigned char *out, unsigned w); // delta of delta
+void trundelta2( const unsigned char *in, size_t n, unsigned char *out, unsigned w);
+void trzigzag(   const unsigned char *in, size_t n, unsigned char *out, unsigned w); // signed -> unsigned: (x << 1) ^ (x >> (w-1))
+void trunzigzag( const unsigned char *in, size_t n, unsigned char *out, unsigned w);
+void trxor(      const unsigned char *in, size_t n, unsigned char *out, unsigned w); // x[i] ^ x[i-1] (floating point: Gorilla)
+void trunxor(    const unsigned char *in, size_t n, unsigned char *out, unsigned w);
+
+#ifdef __cplusplus
+}
+#endif
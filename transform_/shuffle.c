@@ -0,0 +1,340 @@
+/**
+    Copyright (C) powturbo 2013-2016
+    GPL v2 License
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    - homepage : https://sites.google.com/site/powturbo/
+    - github   : https://github.com/powturbo
+    - twitter  : https://twitter.com/powturbo
+    - email    : powturbo [_AT_] gmail [_DOT_] com
+**/
+//	    TurboBench: transform_/shuffle.c - byte/bit shuffle of fixed size elements
+// SIMD for element sizes 1,2,4,8,16: blocks of 16 elements (SSE2) or 32 elements (AVX2, selected at runtime), other sizes scalar.
+// 16 bytes of each of the E byte planes are transposed with 4 rounds of unpacklo/hi_epi8 (vector i with i+E/2),
+// every round rotates the byte address [element|byte] left by 1. Inverse: log2(E) rounds from the planes.
+#include <string.h>
+#include "../conf.h"
+#include "shuffle.h"
+
+  #if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TR_SSE2
+    #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TR_AVX2 __attribute__((target("avx2")))
+    #endif
+  #endif
+
+#define TR_ROUND(_v_, _n_, _lo_, _hi_, _t_) { unsigned _i;\
+  for(_i = 0; _i < (_n_)/2; _i++) { _t_[2*_i] = _lo_(_v_[_i], _v_[_i+(_n_)/2]); _t_[2*_i+1] = _hi_(_v_[_i], _v_[_i+(_n_)/2]); }\
+  for(_i = 0; _i < (_n_); _i++) _v_[_i] = _t_[_i];\
+}
+
+static unsigned trlog2(unsigned e) { unsigned k = 0; while((1u << k) < e) k++; return k; }
+
+//------------------------------------- scalar: elements e0..m-1 ------------------------------------------------------
+static void shufs(const unsigned char *in, size_t m, size_t e0, unsigned char *out, unsigned esize) {
+  size_t e; unsigned b;
+  for(b = 0; b < esize; b++)
+    for(e = e0; e < m; e++) out[b*m+e] = in[e*esize+b];
+}
+
+static void unshufs(const unsigned char *in, size_t m, size_t e0, unsigned char *out, unsigned esize) {
+  size_t e; unsigned b;
+  for(b = 0; b < esize; b++)
+    for(e = e0; e < m; e++) out[e*esize+b] = in[b*m+e];
+}
+
+// bit plane j of byte plane b: m16/8 bytes at out + (b*8+j)*m16/8
+static void bitshufs(const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned esize) {
+  size_t r = m16/8, e; unsigned b, j, t;
+  for(b = 0; b < esize; b++)
+    for(e = e0; e < m16; e += 8)
+      for(j = 0; j < 8; j++) {
+        unsigned c = 0;
+        for(t = 0; t < 8; t++) c |= ((in[(e+t)*esize+b] >> j) & 1) << t;
+        out[(b*8+j)*r + e/8] = c;
+      }
+}
+
+static void bitunshufs(const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned esize) {
+  size_t r = m16/8, e; unsigned b, j, t;
+  for(b = 0; b < esize; b++)
+    for(e = e0; e < m16; e += 8)
+      for(t = 0; t < 8; t++) {
+        unsigned c = 0;
+        for(j = 0; j < 8; j++) c |= ((in[(b*8+j)*r + e/8] >> t) & 1) << j;
+        out[(e+t)*esize+b] = c;
+      }
+}
+
+  #ifdef TR_SSE2
+//------------------------------------- SSE2: 16 elements -----------------------------------------------------------
+static ALWAYS_INLINE void shuf16(const unsigned char *ip, __m128i *v, unsigned E) {
+  __m128i t[16]; unsigned i, r;
+  for(i = 0; i < E; i++) v[i] = _mm_loadu_si128((const __m128i *)(ip + 16*i));
+  if(E > 1) for(r = 0; r < 4; r++) TR_ROUND(v, E, _mm_unpacklo_epi8, _mm_unpackhi_epi8, t);
+}
+
+static ALWAYS_INLINE void unshuf16(__m128i *v, unsigned char *op, unsigned E) {
+  __m128i t[16]; unsigned i, r, k = trlog2(E);
+  for(r = 0; r < k; r++) TR_ROUND(v, E, _mm_unpacklo_epi8, _mm_unpackhi_epi8, t);
+  for(i = 0; i < E; i++) _mm_storeu_si128((__m128i *)(op + 16*i), v[i]);
+}
+
+static ALWAYS_INLINE size_t shuf_sse2(const unsigned char *in, size_t m, size_t e0, size_t m16, unsigned char *out, unsigned E) {
+  __m128i v[16]; size_t e; unsigned i;
+  for(e = e0; e < m16; e += 16) {
+    shuf16(in + e*E, v, E);
+    for(i = 0; i < E; i++) _mm_storeu_si128((__m128i *)(out + i*m + e), v[i]);
+  }
+  return e;
+}
+
+static ALWAYS_INLINE size_t unshuf_sse2(const unsigned char *in, size_t m, size_t e0, size_t m16, unsigned char *out, unsigned E) {
+  __m128i v[16]; size_t e; unsigned i;
+  for(e = e0; e < m16; e += 16) {
+    for(i = 0; i < E; i++) v[i] = _mm_loadu_si128((const __m128i *)(in + i*m + e));
+    unshuf16(v, out + e*E, E);
+  }
+  return e;
+}
+
+// bit planes: 8*E rows collected in a tile of TR_TILE elements and copied out per row. 
+// Direct 2/4 byte stores to rows with power of 2 distances (ex. 64k blocks) are slowed down by 4k aliasing
+#define TR_TILE 256
+#define TR_TW   (TR_TILE/8)
+
+static ALWAYS_INLINE size_t bitshuf_sse2(const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned E) {
+  __m128i v[16]; unsigned char tile[16*8*TR_TW]; size_t r = m16/8, e, w, x; unsigned i, j;
+  for(e = e0; e < m16; e += w) {
+    if((w = m16 - e) > TR_TILE) w = TR_TILE;
+    for(x = 0; x < w; x += 16) {
+      shuf16(in + (e+x)*E, v, E);
+      for(i = 0; i < E; i++) {
+        __m128i y = v[i];
+        for(j = 8; j-- > 0; y = _mm_slli_epi16(y, 1)) {     // msb of each byte: bit j
+          unsigned short u = _mm_movemask_epi8(y);
+          memcpy(tile + (i*8+j)*TR_TW + x/8, &u, 2);
+        }
+      }
+    }
+    for(i = 0; i < 8*E; i++) memcpy(out + i*r + e/8, tile + i*TR_TW, w/8);
+  }
+  return e;
+}
+
+static ALWAYS_INLINE size_t bitunshuf_sse2(const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned E) {
+  __m128i v[16]; unsigned char tile[16*8*TR_TW]; size_t r = m16/8, e, w, x; unsigned i, t;
+  for(e = e0; e < m16; e += w) {
+    if((w = m16 - e) > TR_TILE) w = TR_TILE;
+    for(i = 0; i < 8*E; i++) memcpy(tile + i*TR_TW, in + i*r + e/8, w/8);
+    for(x = 0; x < w; x += 16) {
+      for(i = 0; i < E; i++) {
+        unsigned short u[8]; unsigned j; const unsigned char *tp = tile + i*8*TR_TW + x/8;
+        for(j = 0; j < 8; j++) memcpy(&u[j], tp + j*TR_TW, 2);
+        __m128i z = _mm_set_epi16(u[7], u[6], u[5], u[4], u[3], u[2], u[1], u[0]);
+        z = _mm_packus_epi16(_mm_and_si128(z, _mm_set1_epi16(0xff)), _mm_srli_epi16(z, 8)); // byte j: row j elements 0-7, byte 8+j: elements 8-15
+        for(t = 8; t-- > 0; z = _mm_slli_epi16(z, 1)) u[t] = _mm_movemask_epi8(z);  // byte 0: element t, byte 1: element 8+t
+        z    = _mm_set_epi16(u[7], u[6], u[5], u[4], u[3], u[2], u[1], u[0]);
+        v[i] = _mm_packus_epi16(_mm_and_si128(z, _mm_set1_epi16(0xff)), _mm_srli_epi16(z, 8));
+      }
+      unshuf16(v, out + (e+x)*E, E);
+    }
+  }
+  return e;
+}
+
+#define TR_SWITCH(_f_, _E_, ...) switch(_E_) {\
+  case 1: return _f_(__VA_ARGS__, 1);   case 2: return _f_(__VA_ARGS__, 2); case 4: return _f_(__VA_ARGS__, 4);\
+  case 8: return _f_(__VA_ARGS__, 8);   case 16: return _f_(__VA_ARGS__, 16);\
+}
+static size_t shufv(     const unsigned char *in, size_t m, size_t e0, size_t m16, unsigned char *out, unsigned E) { TR_SWITCH(shuf_sse2,      E, in, m, e0, m16, out); return e0; }
+static size_t unshufv(   const unsigned char *in, size_t m, size_t e0, size_t m16, unsigned char *out, unsigned E) { TR_SWITCH(unshuf_sse2,    E, in, m, e0, m16, out); return e0; }
+static size_t bitshufv(  const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned E)           { TR_SWITCH(bitshuf_sse2,   E, in, m16, e0, out); return e0; }
+static size_t bitunshufv(const unsigned char *in, size_t m16, size_t e0, unsigned char *out, unsigned E)           { TR_SWITCH(bitunshuf_sse2, E, in, m16, e0, out); return e0; }
+
+    #ifdef TR_AVX2
+//------------------------------------- AVX2: 32 elements, lane 0: elements 0-15, lane 1: elements 16-31 ----------------------
+static ALWAYS_INLINE TR_AVX2 void shuf32(const unsigned char *ip, __m256i *v, unsigned E) {
+  __m256i t[16]; unsigned i, r;
+  for(i = 0; i < E; i += 2) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(ip + 16*i)), b = _mm256_loadu_si256((const __m256i *)(ip + 16*E + 16*i));
+    v[i] = _mm256_permute2x128_si256(a, b, 0x20); v[i+1] = _mm256_permute2x128_si256(a, b, 0x31);
+  }
+  for(r = 0; r < 4; r++) TR_ROUND(v, E, _mm256_unpacklo_epi8, _mm256_unpackhi_epi8, t);
+}
+
+static ALWAYS_INLINE TR_AVX2 void unshuf32(__m256i *v, unsigned char *op, unsigned E) {
+  __m256i t[16]; unsigned i, r, k = trlog2(E);
+  for(r = 0; r < k; r++) TR_ROUND(v, E, _mm256_unpacklo_epi8, _mm256_unpackhi_epi8, t);
+  for(i = 0; i < E; i += 2) {
+    _mm256_storeu_si256((__m256i *)(op + 16*i),        _mm256_permute2x128_si256(v[i], v[i+1], 0x20));
+    _mm256_storeu_si256((__m256i *)(op + 16*E + 16*i), _mm256_permute2x128_si256(v[i], v[i+1], 0x31));
+  }
+}
+
+static ALWAYS_INLINE TR_AVX2 size_t shuf_avx2(const unsigned char *in, size_t m, size_t m16, unsigned char *out, unsigned E) {
+  __m256i v[16]; size_t e; unsigned i;
+  for(e = 0; e+32 <= m16; e += 32) {
+    shuf32(in + e*E, v, E);
+    for(i = 0; i < E; i++) _mm256_storeu_si256((__m256i *)(out + i*m + e), v[i]);
+  }
+  return e;
+}
+
+static ALWAYS_INLINE TR_AVX2 size_t unshuf_avx2(const unsigned char *in, size_t m, size_t m16, unsigned char *out, unsigned E) {
+  __m256i v[16]; size_t e; unsigned i;
+  for(e = 0; e+32 <= m16; e += 32) {
+    for(i = 0; i < E; i++) v[i] = _mm256_loadu_si256((const __m256i *)(in + i*m + e));
+    unshuf32(v, out + e*E, E);
+  }
+  return e;
+}
+
+static ALWAYS_INLINE TR_AVX2 size_t bitshuf_avx2(const unsigned char *in, size_t m16, unsigned char *out, unsigned E) {
+  __m256i v[16]; unsigned char tile[16*8*TR_TW]; size_t r = m16/8, e, w, x; unsigned i, j;
+  for(e = 0; e+32 <= m16; e += w) {
+    if((w = (m16 - e) & ~(size_t)31) > TR_TILE) w = TR_TILE;
+    for(x = 0; x < w; x += 32) {
+      shuf32(in + (e+x)*E, v, E);
+      for(i = 0; i < E; i++) {
+        __m256i y = v[i];
+        for(j = 8; j-- > 0; y = _mm256_slli_epi16(y, 1)) {
+          unsigned u = _mm256_movemask_epi8(y);
+          memcpy(tile + (i*8+j)*TR_TW + x/8, &u, 4);
+        }
+      }
+    }
+    for(i = 0; i < 8*E; i++) memcpy(out + i*r + e/8, tile + i*TR_TW, w/8);
+  }
+  return e;
+}
+
+static ALWAYS_INLINE TR_AVX2 size_t bitunshuf_avx2(const unsigned char *in, size_t m16, unsigned char *out, unsigned E) {
+  __m256i v[16], ctl = _mm256_set_epi8(15,11,7,3,14,10,6,2,13,9,5,1,12,8,4,0, 15,11,7,3,14,10,6,2,13,9,5,1,12,8,4,0), 
+          prm = _mm256_set_epi32(7,3,6,2,5,1,4,0);
+  unsigned char tile[16*8*TR_TW]; size_t r = m16/8, e, w, x; unsigned i, t;
+  for(e = 0; e+32 <= m16; e += w) {
+    if((w = (m16 - e) & ~(size_t)31) > TR_TILE) w = TR_TILE;
+    for(i = 0; i < 8*E; i++) memcpy(tile + i*TR_TW, in + i*r + e/8, w/8);
+    for(x = 0; x < w; x += 32) {
+      for(i = 0; i < E; i++) {
+        unsigned u[8], j; const unsigned char *tp = tile + i*8*TR_TW + x/8;
+        for(j = 0; j < 8; j++) memcpy(&u[j], tp + j*TR_TW, 4);
+        __m256i z = _mm256_set_epi32(u[7], u[6], u[5], u[4], u[3], u[2], u[1], u[0]);
+        z = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(z, ctl), prm); // bytes 8k..8k+7: byte k of rows 0..7 
+        for(t = 8; t-- > 0; z = _mm256_slli_epi16(z, 1)) u[t] = _mm256_movemask_epi8(z); // byte k: element 8k+t
+        z    = _mm256_set_epi32(u[7], u[6], u[5], u[4], u[3], u[2], u[1], u[0]);
+        v[i] = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(z, ctl), prm);
+      }
+      unshuf32(v, out + (e+x)*E, E);
+    }
+  }
+  return e;
+}
+
+#define TR_SWITCH2(_f_, _E_, ...) switch(_E_) {\
+  case 2: return _f_(__VA_ARGS__, 2);   case 4: return _f_(__VA_ARGS__, 4); case 8: return _f_(__VA_ARGS__, 8); case 16: return _f_(__VA_ARGS__, 16);\
+}
+static TR_AVX2 size_t shufv2(     const unsigned char *in, size_t m, size_t m16, unsigned char *out, unsigned E) { TR_SWITCH2(shuf_avx2,      E, in, m, m16, out); return 0; }
+static TR_AVX2 size_t unshufv2(   const unsigned char *in, size_t m, size_t m16, unsigned char *out, unsigned E) { TR_SWITCH2(unshuf_avx2,    E, in, m, m16, out); return 0; }
+static TR_AVX2 size_t bitshufv2(  const unsigned char *in, size_t m16, unsigned char *out, unsigned E)            { TR_SWITCH2(bitshuf_avx2,   E, in, m16, out); return 0; }
+static TR_AVX2 size_t bitunshufv2(const unsigned char *in, size_t m16, unsigned char *out, unsigned E)            { TR_SWITCH2(bitunshuf_avx2, E, in, m16, out); return 0; }
+
+static int travx2 = -1;
+#define TR_AVX2OK (travx2 < 0?(travx2 = __builtin_cpu_supports("avx2")):travx2)
+    #else
+#define TR_AVX2OK 0
+#define shufv2(     _in_, _m_, _m16_, _out_, _E_) 0
+#define unshufv2(   _in_, _m_, _m16_, _out_, _E_) 0
+#define bitshufv2(  _in_, _m16_, _out_, _E_) 0
+#define bitunshufv2(_in_, _m16_, _out_, _E_) 0
+    #endif
+  #endif
+
+//------------------------------------- API -------------------------------------------------------------------------
+#define TR_POW2(_e_) ((_e_) <= 16 && !((_e_) & ((_e_)-1)))
+
+void trshuf(const unsigned char *in, size_t n, unsigned char *out, unsigned esize) {
+  size_t m = esize?n/esize:0, e = 0;
+  if(esize <= 1) { memcpy(out, in, n); return; }
+    #ifdef TR_SSE2
+  if(TR_POW2(esize)) {
+    size_t m16 = m & ~(size_t)15;
+    if(TR_AVX2OK) e = shufv2(in, m, m16, out, esize);
+    e = shufv(in, m, e, m16, out, esize);
+  }
+    #endif
+  shufs(in, m, e, out, esize);
+  memcpy(out + m*esize, in + m*esize, n - m*esize);
+}
+
+void trunshuf(const unsigned char *in, size_t n, unsigned char *out, unsigned esize) {
+  size_t m = esize?n/esize:0, e = 0;
+  if(esize <= 1) { memcpy(out, in, n); return; }
+    #ifdef TR_SSE2
+  if(TR_POW2(esize)) {
+    size_t m16 = m & ~(size_t)15;
+    if(TR_AVX2OK) e = unshufv2(in, m, m16, out, esize);
+    e = unshufv(in, m, e, m16, out, esize);
+  }
+    #endif
+  unshufs(in, m, e, out, esize);
+  memcpy(out + m*esize, in + m*esize, n - m*esize);
+}
+
+void trbitshuf(const unsigned char *in, size_t n, unsigned char *out, unsigned esize) {
+  size_t m = esize?n/esize:0, m16 = m & ~(size_t)15, e = 0;
+  if(!esize) esize = 1;
+    #ifdef TR_SSE2
+  if(TR_POW2(esize)) {
+    if(TR_AVX2OK && esize > 1) e = bitshufv2(in, m16, out, esize);
+    e = bitshufv(in, m16, e, out, esize);
+  }
+    #endif
+  bitshufs(in, m16, e, out, esize);
+  memcpy(out + m16*esize, in + m16*esize, n - m16*esize);
+}
+
+void trbitunshuf(const unsigned char *in, size_t n, unsigned char *out, unsigned esize) {
+  size_t m = esize?n/esize:0, m16 = m & ~(size_t)15, e = 0;
+  if(!esize) esize = 1;
+    #ifdef TR_SSE2
+  if(TR_POW2(esize)) {
+    if(TR_AVX2OK && esize > 1) e = bitunshufv2(in, m16, out, esize);
+    e = bitunshufv(in, m16, e, out, esize);
+  }
+    #endif
+  bitunshufs(in, m16, e, out, esize);
+  memcpy(out + m16*esize, in + m16*esize, n - m16*esize);
+}
+
+// record size: the distance s with the most equal bytes in[i] == in[i-s] in the first 4KB.
+// A divisor of s with nearly the same count is preferred (ex. 4 for arrays of 3 floats).
+#define TR_SAMPLE 4096
+unsigned trstride(const unsigned char *in, size_t n, unsigned smax) {
+  unsigned c[65], s, best = 1; size_t i, l = n < TR_SAMPLE?n:TR_SAMPLE;
+  if(smax > 64) smax = 64;
+  if(l < 4*smax) return 1;
+  for(s = 1; s <= smax; s++)
+    for(c[s] = 0, i = smax; i < l; i++) c[s] += in[i] == in[i-s];
+  for(s = 2; s <= smax; s++) if(c[s] > c[best]) best = s;
+  if(c[best] < (l - smax)/8) return 1;
+  for(s = 2; s < best; s++)
+    if(!(best % s) && c[s] >= c[best] - c[best]/16) return s;
+  return best;
+}
@@ -0,0 +1,40 @@
+/**
+    Copyright (C) powturbo 2013-2016
+    GPL v2 License
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+    - homepage : https://sites.google.com/site/powturbo/
+    - github   : https://github.com/powturbo
+    - twitter  : https://twitter.com/powturbo
+    - email    : powturbo [_AT_] gmail [_DOT_] com
+**/
+//	    TurboBench: transform_/shuffle.h - byte/bit shuffle of fixed size elements (SSE2/AVX2 + scalar)
+// byte shuffle: n/esize elements -> esize planes: byte 0 of all elements, byte 1, ...  remaining n%esize bytes copied
+// bit  shuffle: bit planes of the byte planes in groups of 16 elements, remaining elements + bytes copied
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stddef.h>
+
+void     trshuf(     const unsigned char *in, size_t n, unsigned char *out, unsigned esize);
+void     trunshuf(   const unsigned char *in, size_t n, unsigned char *out, unsigned esize);
+void     trbitshuf(  const unsigned char *in, size_t n, unsigned char *out, unsigned esize);
+void     trbitunshuf(const unsigned char *in, size_t n, unsigned char *out, unsigned esize);
+unsigned trstride(   const unsigned char *in, size_t n, unsigned smax); // detect the record size (1..smax) , 1=no stride found
+
+#ifdef __cplusplus
+}
+#endif
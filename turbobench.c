@@ -30,6 +30,7 @@
 #include <stdlib.h> 
 #include <inttypes.h> 
 #include <float.h> 
+#include <math.h> 
 #include <errno.h>
 #include <malloc.h>			
 #include <sys/types.h>
@@ -49,6 +50,9 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
   #else
 #include <io.h>
 #include <fcntl.h>
@@ -77,7 +81,7 @@ static   tm_t tminit()        { tm_t t0=tmtime(),ts; while((ts = tmtime())==t0);
 #define TMDEF unsigned tm_r,tm_R; tm_t _t0,_tc,_ts;
 #define TMSLEEP do { tm_T = tmtime(); if(!tm_0) tm_0 = tm_T; else if(tm_T - tm_0 > tm_TX) { printf("S \b\b");fflush(stdout); sleep(tm_slp); tm_0=tmtime();} } while(0)
 #define TMBEG(__c,__tm_reps,__tm_Reps) \
-  for(tm_tm = TM_MAX,tm_R=0,_ts=tmtime(); tm_R < __tm_Reps; tm_R++) { if(__tm_reps>1) TMSLEEP; printf("%c%d\b\b",__c,tm_R+1);fflush(stdout);\
+  for(tm_tm = TM_MAX,tm_R=0,_ts=tmtime(); tm_R < __tm_Reps; tm_R++) { if(__tm_reps>1) TMSLEEP; if(tm_prt) { printf("%c%d\b\b",__c,tm_R+1);fflush(stdout); }\
     for(_t0 = tminit(), tm_r=0; tm_r < __tm_reps;) {
 
 #define TMEND tm_r++; tm_T = tmtime(); if((_tc = (tm_T - _t0)) > tm_tx) break; } if(_tc < tm_tm) tm_tm = _tc,tm_rm=tm_r; if(tm_T-_ts > tm_TX) break; }
@@ -85,6 +89,7 @@ static   tm_t tminit()        { tm_t t0=tmtime(),ts; while((ts = tmtime())==t0);
 
 static unsigned tm_repc = 1<<30, tm_Repc = 3, tm_repd = 1<<30, tm_Repd = 4, tm_rm, tm_slp = 60;
 static tm_t     tm_tm, tm_tx = 2*TM_T, tm_TX = 120*TM_T, tm_0, tm_T, tm_RepkT=24*3600*TM_T;
+static int      tm_prt = 1;                                 // progress output in TMBEG
 
 //: b 512, kB 1000, K  1024,  MB 1000*1000,  M  1024*1024,  GB  1000*1000*1000,  G 1024*1024*1024
 
@@ -149,19 +154,109 @@ int strpref(const char *const *str, int n, char sep1, char sep2) {
   return 0;
 }
 
-void memrcpy(unsigned char *out, unsigned char *in, unsigned n) { int i; for(i = 0; i < n; i++) out[i] = ~in[i]; }
+//------------------------------- Verification: SSE2 compare + block hash (XXH3 style accumulate) ----------
+  #ifdef __SSE2__
+#include <emmintrin.h>
+  #endif
+
+void memrcpy(unsigned char *out, unsigned char *in, unsigned n) { // out = ~in (in == out allowed)
+  unsigned i = 0; 
+    #ifdef __SSE2__
+  __m128i f = _mm_set1_epi8(-1);
+  for(; i+16 <= n; i += 16) _mm_storeu_si128((__m128i *)(out+i), _mm_xor_si128(_mm_loadu_si128((__m128i *)(in+i)), f));
+    #endif
+  for(; i < n; i++) out[i] = ~in[i]; 
+}
+
+static unsigned memdiff(unsigned char *a, unsigned char *b, unsigned n) { // index of the first difference or n
+  unsigned i = 0;
+    #ifdef __SSE2__
+  for(; i+64 <= n; i += 64) {
+    __m128i c = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a+i)),    _mm_loadu_si128((__m128i *)(b+i))), 
+                                            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a+i+16)), _mm_loadu_si128((__m128i *)(b+i+16)))),
+                              _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a+i+32)), _mm_loadu_si128((__m128i *)(b+i+32))), 
+                                            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a+i+48)), _mm_loadu_si128((__m128i *)(b+i+48)))));
+    if(_mm_movemask_epi8(c) != 0xffff) break;
+  }
+    #endif
+  for(; i < n && a[i] == b[i]; i++);
+  return i;
+}
 
 int memcheck(unsigned char *in, unsigned n, unsigned char *cpy, int cmp) { 
-  int i;
+  unsigned i;
+  if(cmp <= 1) 
+    return 0;
+  if((i = memdiff(in, cpy, n)) < n) {
+    if(cmp > 3) abort(); // crash (AFL) fuzzing
+    printf("ERROR at %d:%x, %x\n", i, in[i], cpy[i]); 
+    if(cmp > 2) exit(EXIT_FAILURE);      
+    return i+1; 
+  }
+  return 0;
+}
+
+#define HBLK (1u<<16)                                       // hash block size
+static const unsigned long long hsec[8] = { 0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull, 
+                                            0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull };
+
+static unsigned long long hfold(unsigned long long a, unsigned long long b) { // 64x64->128 bits multiply folded to 64 bits 
+    #ifdef __SIZEOF_INT128__
+  unsigned __int128 m = (unsigned __int128)a * b; return (unsigned long long)m ^ (unsigned long long)(m >> 64);
+    #else
+  return a*b ^ (a >> 32)*(b >> 32);
+    #endif
+}
+
+static void hacc(unsigned long long *acc, const unsigned char *p, size_t ns) { // accumulate ns stripes of 64 bytes
+    #ifdef __SSE2__
+  __m128i a0 = _mm_loadu_si128((__m128i *)acc),   a1 = _mm_loadu_si128((__m128i *)(acc+2)), 
+          a2 = _mm_loadu_si128((__m128i *)(acc+4)), a3 = _mm_loadu_si128((__m128i *)(acc+6));
+  #define HACC(_a_,_j_) { __m128i d = _mm_loadu_si128((__m128i *)(p+16*_j_)), k = _mm_xor_si128(d, _mm_loadu_si128((__m128i *)(hsec+2*_j_)));\
+    _a_ = _mm_add_epi64(_a_, _mm_add_epi64(_mm_shuffle_epi32(d, _MM_SHUFFLE(1,0,3,2)), _mm_mul_epu32(k, _mm_shuffle_epi32(k, _MM_SHUFFLE(0,3,0,1))))); }
+  for(; ns; ns--, p += 64) { HACC(a0,0); HACC(a1,1); HACC(a2,2); HACC(a3,3); }
+  _mm_storeu_si128((__m128i *)acc, a0); _mm_storeu_si128((__m128i *)(acc+2), a1); _mm_storeu_si128((__m128i *)(acc+4), a2); _mm_storeu_si128((__m128i *)(acc+6), a3);
+    #else
+  for(; ns; ns--, p += 64) { int i;
+    for(i = 0; i < 8; i++) { unsigned long long d, k; memcpy(&d, p+8*i, 8); k = d ^ hsec[i]; acc[i^1] += d; acc[i] += (k & 0xffffffffu)*(k >> 32); }
+  }
+    #endif
+}
+
+unsigned long long memhash(const unsigned char *p, size_t n) {
+  unsigned long long acc[8] = { 0xC2B2AE3Dull, 0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 
+                                0x85EBCA77C2B2AE63ull, 0x85EBCA77ull, 0x27D4EB2F165667C5ull, 0x9E3779B1ull }, h = n*0x9E3779B185EBCA87ull; 
+  size_t ns = n/64, s; unsigned char t[64]; int i;
+  for(s = 0; s < ns; s += 16) {                             // blocks of 16 stripes + scramble
+    hacc(acc, p+s*64, min(16, ns-s));
+    if(ns-s >= 16) 
+      for(i = 0; i < 8; i++) acc[i] = (acc[i] ^ (acc[i] >> 47) ^ hsec[i]) * 0x9E3779B1u;
+  }
+  if(n & 63) { memset(t, 0, 64); memcpy(t, p+ns*64, n & 63); hacc(acc, t, 1); }
+  for(i = 0; i < 8; i += 2) h += hfold(acc[i] ^ hsec[i], acc[i+1] ^ hsec[i+1]);
+  h ^= h >> 37; h *= 0x165667919E3779F9ull; 
+  return h ^ (h >> 32);
+}
+
+static void memhashv(unsigned char *p, size_t n, unsigned long long *hv) { size_t i; // hash per HBLK block
+  for(i = 0; i < n; i += HBLK) *hv++ = memhash(p+i, min(HBLK, n-i));
+}
+
+static size_t memhashdiff(unsigned char *p, size_t n, unsigned long long *hv) { size_t i; // offset of the first block with a different hash or n
+  for(i = 0; i < n; i += HBLK, hv++) if(memhash(p+i, min(HBLK, n-i)) != *hv) return i;
+  return n;
+}
+
+int memhcheck(unsigned char *p, size_t n, unsigned long long *hv, int cmp) { 
+  size_t i;
   if(cmp <= 1) 
     return 0;
-  for(i = 0; i < n; i++)
-    if(in[i] != cpy[i]) {
-      if(cmp > 3) abort(); // crash (AFL) fuzzing
-      printf("ERROR at %d:%x, %x\n", i, in[i], cpy[i]); 
-      if(cmp > 2) exit(EXIT_FAILURE);      
-	  return i+1; 
-	}
+  if((i = memhashdiff(p, n, hv)) < n) {
+    if(cmp > 3) abort();
+    printf("ERROR in block %u at %u (hash)\n", (unsigned)(i/HBLK), (unsigned)i); 
+    if(cmp > 2) exit(EXIT_FAILURE);      
+    return i+1; 
+  }
   return 0;
 }
 //------------------------------- malloc ------------------------------------------------
@@ -232,6 +327,109 @@ void mem_sub(size_t size) {
     mem_used -= size; 
 }
 
+//------------- allocation profiler (-A#) : counts, size/lifetime histograms and sampled call sites per phase
+  #ifdef __GLIBC__
+#include <execinfo.h>
+  #endif
+#define MP_HIST   32                                        // log2 buckets
+#define MP_LIVE   (1<<16)                                   // live allocations tracked for lifetimes
+#define MP_SITES  256
+#define MP_SITEF  3                                         // call site = 3 return addresses
+#define MP_SAMPLE 16                                        // backtrace every 16th allocation
+
+struct mpsite { void *a[MP_SITEF]; unsigned long long n, bytes; };
+struct mprof  { unsigned long long nsample, nmalloc, nfree, nrealloc, bytes, calls, inlen, hist[MP_HIST], life[MP_HIST]; struct mpsite site[MP_SITES]; };
+
+static struct mprof mprof[2];                               // 0:compression 1:decompression
+static int          memprof, mprof_phase = -1, mprof_busy;
+static struct { void *p; tm_t t; } mprof_live[MP_LIVE];
+
+#define MPHASH(_p_) ((unsigned)(((unsigned long long)(size_t)(_p_) >> 4) * 0x9E3779B97F4A7C15ull >> 48) & (MP_LIVE-1))
+
+void memprofini(void) { 
+  if(!memprof) return;
+  memset(mprof, 0, sizeof(mprof)); memset(mprof_live, 0, sizeof(mprof_live));
+    #ifdef __GLIBC__
+  static int bt; 
+  if(memprof > 1 && !bt++) { void *a[2]; backtrace(a, 2); } // first backtrace() loads libgcc
+    #endif
+}
+
+void memprofbeg(int phase) { if(memprof) mprof_phase = phase; }
+
+void memprofend(void) { mprof_phase = -1; }
+
+static void mprof_alloc(void *p, size_t size, int re) {
+  if(mprof_phase < 0 || mprof_busy || !p) return;
+  mprof_busy++;
+  struct mprof *m = &mprof[mprof_phase];
+  unsigned      i, h = MPHASH(p);
+  if(!re) m->nmalloc++;
+  m->bytes += size; m->hist[size?bsr64(size-1):0]++;
+  for(i = 0; i < 8; i++, h = (h+1) & (MP_LIVE-1))
+    if(!mprof_live[h].p) { mprof_live[h].p = p; mprof_live[h].t = tmtime(); break; }
+    #ifdef __GLIBC__
+  if(memprof > 1 && !(++m->nsample % MP_SAMPLE)) {
+    void *a[MP_SITEF+1]; 
+    int   n = backtrace(a, MP_SITEF+1), j;                  // a[0] is in the malloc hook
+    for(j = n; j <= MP_SITEF; j++) a[j] = NULL;
+    h = (unsigned)(((size_t)a[1] ^ (size_t)a[2]>>3 ^ (size_t)a[3]>>7) * 0x9E3779B1u) % MP_SITES;
+    for(i = 0; i < MP_SITES; i++, h = (h+1) % MP_SITES) {
+      struct mpsite *s = &m->site[h];
+      if(!s->n) memcpy(s->a, &a[1], sizeof(s->a));
+      else if(memcmp(s->a, &a[1], sizeof(s->a))) continue;
+      s->n++; s->bytes += size;
+      break;
+    }
+  }
+    #endif
+  mprof_busy--;
+}
+
+static void mprof_free(void *p, int re) {
+  if(mprof_phase < 0 || mprof_busy || !p) return;
+  struct mprof *m = &mprof[mprof_phase];
+  unsigned      i, h = MPHASH(p);
+  if(re) m->nrealloc++; else m->nfree++;
+  for(i = 0; i < 8; i++, h = (h+1) & (MP_LIVE-1))
+    if(mprof_live[h].p == p) { 
+      tm_t t = tmtime() - mprof_live[h].t; 
+      m->life[t?bsr64(t):0]++; 
+      mprof_live[h].p = NULL; 
+      break; 
+    }
+}
+
+#define MEMPROF_CALL(_l_) if(mprof_phase >= 0) { mprof[mprof_phase].calls++; mprof[mprof_phase].inlen += (_l_); }
+
+static int mpsitecmp(const struct mpsite *a, const struct mpsite *b) { return a->n < b->n?1:(a->n > b->n?-1:0); }
+
+void memprofprt(char *name, int phase) {
+  struct mprof *m = &mprof[phase];
+  int i;
+  if(!memprof || !m->calls) return;
+  double mb = (double)m->inlen/MBS;
+  printf("%c memprof %-16s %llu malloc %llu free %llu realloc, %.2f allocs/call, %.2f allocs/MB, %.2f MB allocated\n", "CD"[phase], name, 
+    m->nmalloc, m->nfree, m->nrealloc, (double)m->nmalloc/m->calls, mb>0?(double)m->nmalloc/mb:0.0, (double)m->bytes/MBS);
+  if(!m->nmalloc) return;
+  printf("  size <=: ");
+  for(i = 0; i < MP_HIST; i++) if(m->hist[i]) printf("%llu:%llu ", 1ull<<i, m->hist[i]); 
+  printf("\n  life us: ");
+  for(i = 0; i < MP_HIST; i++) if(m->life[i]) printf("<%llu:%llu ", 2ull<<i, m->life[i]); 
+  printf("\n");
+    #ifdef __GLIBC__
+  if(memprof > 1) {
+    qsort(m->site, MP_SITES, sizeof(m->site[0]), (int(*)(const void*,const void*))mpsitecmp);
+    for(i = 0; i < 5 && m->site[i].n; i++) {
+      char **sym = backtrace_symbols(m->site[i].a, MP_SITEF);
+      printf("  site %d: ~%llu allocs ~%llu bytes", i+1, m->site[i].n*MP_SAMPLE, m->site[i].bytes*MP_SAMPLE);
+      if(sym) { int j; for(j = 0; j < MP_SITEF && m->site[i].a[j]; j++) printf(" < %s", sym[j]); free(sym); }
+      printf("\n");
+    }
+  }
+    #endif
+}
+
 void *malloc(size_t size) {
   if(!mem_malloc) {
     void *p = mem_heapp;
@@ -242,6 +440,7 @@ void *malloc(size_t size) {
   void *p = (*mem_malloc)(size);
   if(p) 
     mem_add(malloc_usable_size(p)); 
+  mprof_alloc(p, size, 0);
   return p;
 }
 
@@ -257,6 +456,7 @@ void *calloc(size_t nmemb, size_t size) {
   void *p = (*mem_calloc)(nmemb, size);
   if(p) 
     mem_add(malloc_usable_size(p)); 
+  mprof_alloc(p, _size, 0);
   return p;
 }
 
@@ -267,13 +467,17 @@ void *memalign(size_t nmemb, size_t size) {
   void *p = (*mem_memalign)(nmemb, size);      
   if(p) 
     mem_add(malloc_usable_size(p)); 
+  mprof_alloc(p, size, 0);
   return p;
 }
 
 void *realloc(void *p, size_t size) { 
+  int re = p != NULL;
   mem_sub(malloc_usable_size(p));
+  mprof_free(p, 1);
   if(p = (*mem_realloc)(p, size))
     mem_add(malloc_usable_size(p)); 
+  mprof_alloc(p, size, re);
   return p;
 }
 
@@ -281,6 +485,7 @@ void free(void *p) {
    if(!p || p >= (void*)mem_heap && p < (void*)mem_heapp) 
      return; 
    mem_sub(malloc_usable_size(p));
+   mprof_free(p, 0);
   (*mem_free)(p); 
 } 
   #else
@@ -288,6 +493,50 @@ void free(void *p) {
 #define mempeakinit() 0
 void mem_add(size_t size) {}
 void mem_sub(size_t size) {}
+#define memprofini()
+#define memprofbeg(_phase_)
+#define memprofend()
+#define memprofprt(_name_, _phase_)
+#define MEMPROF_CALL(_l_)
+static int memprof;
+  #endif
+
+//------------------------------- rss + page faults -------------------------------------
+// memory mapped by the codecs, static tables and first touch costs are not seen by the malloc hooks.
+// Peak RSS (VmHWM, reset by writing "5" to /proc/self/clear_refs) and the minor/major page faults are measured per phase
+  #if defined(__linux__)
+static long long rssget(const char *key) {                  // read a "kB" field from /proc/self/status w/o malloc
+  char s[4096],*p;
+  int  fd = open("/proc/self/status", O_RDONLY), n;
+  if(fd < 0) return 0;
+  n = read(fd, s, sizeof(s)-1); close(fd);
+  if(n <= 0) return 0;
+  s[n] = 0;
+  if(!(p = strstr(s, key))) return 0;
+  return strtoll(p+strlen(key), NULL, 10)*1024;
+}
+
+long long rssinit() {                                       // reset peak rss & return current rss
+  int fd = open("/proc/self/clear_refs", O_WRONLY);
+  if(fd >= 0) {
+    if(write(fd, "5", 1) != 1) {}
+    close(fd);
+  }
+  return rssget("VmRSS:");
+}
+
+long long rsspeak() { return rssget("VmHWM:"); }
+
+void pfget(long long *minflt, long long *majflt) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  *minflt = ru.ru_minflt;
+  *majflt = ru.ru_majflt;
+}
+  #else
+long long rssinit() { return 0; }
+long long rsspeak() { return 0; }
+void pfget(long long *minflt, long long *majflt) { *minflt = *majflt = 0; }
   #endif
 
 //--------------------------------------- TurboBench ------------------------------------------------------------------
@@ -388,16 +637,21 @@ void plugsprtv(FILE *f, int fmt) {
 }
 
 //------------------ plugin: process ----------------------------------
+#define KSMAX 32
+#define PRMLEN 32
+#define NAMELEN 255                                         // codec name incl. pipelines ex. "delta:32+lz4:9+fse"
 struct plug { 
   int       id,err,blksize,lev;
-  char      *s,prm[17],tms[20]; 
+  char      *s,prm[PRMLEN+1],tms[20]; 
   long long len,memc,memd;
+  long long rssc,rssd,pfc,pfd,pfmc,pfmd; // peak rss, minor + major page faults
   double    tc,td,tck,tdk;
+  double    tcs[KSMAX],tds[KSMAX]; int ks;     // de/compression time of each -k run (A/B significance)
 };
 
 struct plug plug[255],plugt[255];
 int         seg_ans = 32*1024, seg_huf = 32*1024, seg_anx = 12*1024, seg_hufx=11*1024;
-static int  cmp = 2,trans, verbose=1;
+static int  cmp = 2, verbose=1, balloc;
 double      fac = 1.3;
 
 int plugins(struct plug *plug, struct plugs *gs, int *pk, unsigned bsize, int bsizex, int lev, char *prm) { 
@@ -411,8 +665,8 @@ int plugins(struct plug *plug, struct plugs *gs, int *pk, unsigned bsize, int bs
   plug[k].err = 0; 
   plug[k].s   = gs->s; 
   plug[k].lev = lev; 
-  strncpy(plug[k].prm, prm?prm:(char *)"", 16); 
-  plug[k].prm[16] = 0;
+  strncpy(plug[k].prm, prm?prm:(char *)"", PRMLEN); 
+  plug[k].prm[PRMLEN] = 0;
   plug[k].tms[0]  = 0;
   if(gs->flag & E_ANS)  
     plug[k].blksize = seg_ans;
@@ -430,10 +684,12 @@ int plugreg(struct plug *plug, char *cmd, int k, int bsize, int bsizex) {
   while(*cmd) { 
     while(isspace(*cmd)) 
       cmd++; 
-    char *name = cmd; 
-    while(isalnum(*cmd) || *cmd == '_' || *cmd == '-') 
+    char *name = cmd, dl; 
+    while(isalnum(*cmd) || *cmd == '_' || *cmd == '-' || *cmd == '+' || *cmd == ':')   // '+': pipeline ex. srle+lz4:9+fse 
       cmd++; 
-    if(*cmd) *cmd++ = 0;
+    if((dl = *cmd)) *cmd++ = 0;
+    if(strchr(name, '+') && plugpipe(name) && !ignore)
+      exit(0);
 
     if(!strcmp(name, "ON" )) { 
       ignore = 1; 
@@ -453,6 +709,13 @@ int plugreg(struct plug *plug, char *cmd, int k, int bsize, int bsizex) {
       if(prm == cmd) { 
         lev = -1; 
         prm = cempty; 
+        if(dl == ',' && isalpha(*cmd)) {                    // parameter w/o level ex. bzip2,s
+          prm = cmd;
+          while(isalnum(*cmd) || *cmd == '_' || *cmd == '-') 
+            cmd++; 
+          if(*cmd) 
+            *cmd++ = 0; 
+        }
       }
       else if(isalnum(*cmd)) {
         prm = cmd;
@@ -502,11 +765,13 @@ int plugreg(struct plug *plug, char *cmd, int k, int bsize, int bsizex) {
 //------------------ plugin: print/plot -----------------------------
 struct bandw {
   unsigned long long bw;
-  unsigned           rtt; 
+  double             rtt;                                   // round trip time in ms
   char               *s;
+  unsigned           conc;                                  // concurrent requests (0,1=single stream)
+  double             ovh;                                   // overhead per request in us
 };
 
-static struct bandw bw[] = {
+static struct bandw bw_[] = {
   {    7*KB, 500, "GPRS 56"  },//56kbps
   {   57*KB, 150, "2G 456"   },
   {  125*KB,  40, "3G 1M"    },
@@ -523,7 +788,36 @@ static struct bandw bw[] = {
   { 4ull*GB,   0, "4GB/s"    },
   { 8ull*GB,   0, "8GB/s"    }
 };
-#define BWSIZE (sizeof(bw)/sizeof(struct bandw))
+static struct bandw *bw = bw_;
+static unsigned     bwn = sizeof(bw_)/sizeof(bw_[0]), spcores = 1, sppipe;
+
+// transfer profiles "file[,c#][,p]": c# decompression cores, p pipelined transfer+decompression. 
+// file lines: name bandwidth(K,M,G=1000 k,m,g=1024, default MB) rtt_ms [concurrency [overhead_us]], '#' comment
+void bwload(char *arg) {
+  char *q, *fn = arg, s[256];
+  if((q = strchr(arg, ','))) *q++ = 0;
+  if((*fn == 'c' && isdigit(fn[1])) || !strcmp(fn, "p")) { if(q) q[-1] = ','; q = fn; fn = ""; }
+  for(; q && *q; ) {
+    if(*q == 'c') spcores = atoi(q+1); else if(*q == 'p') sppipe = 1;
+    if((q = strchr(q, ','))) q++;
+  }
+  if(spcores < 1) spcores = 1;
+  if(!*fn) return;
+  FILE *fi = fopen(fn, "r"); if(!fi) { perror(fn); die("open error '%s'\n", fn); }
+  struct bandw *t = NULL; unsigned n = 0, m = 0;
+  while(fgets(s, sizeof(s), fi)) {
+    char name[64], sbw[32]; double rtt = 0, ovh = 0; unsigned conc = 1; 
+    if((q = strchr(s, '#'))) *q = 0;
+    if(sscanf(s, "%63s %31s %lf %u %lf", name, sbw, &rtt, &conc, &ovh) < 2) continue;
+    if(n >= m && !(t = (struct bandw *)realloc(t, (m = m?2*m:16)*sizeof(t[0])))) die("malloc error\n");
+    struct bandw *b = &t[n++]; 
+    b->bw = argtol(sbw); b->rtt = rtt; b->s = strdup(name); b->conc = conc; b->ovh = ovh;
+    if(!b->bw) die("bandwidth 0 in '%s'\n", fn);
+  }
+  fclose(fi);
+  if(!n) die("no transfer profile in '%s'\n", fn);
+  bw = t; bwn = n;
+}
 
 void plugprth(FILE *f, int fmt, char *t) {
   char *plot  = "<script src=https://cdn.plot.ly/plotly-latest.min.js></script>";
@@ -577,7 +871,7 @@ void plugprtth(FILE *f, int fmt) {
       fprintf(f,"<pre><b>%s</b> MB=1.000.0000\n", head); 
       break;
     case FMT_HTML:     
-      fprintf(f,"<h3>TurboBench: Compressor Benchmark</h3><table id='myTable' class='tablesorter' style=\"width:35%%\"><thead><tr><th>C Size</th><th>ratio%%</th><th>C MB/s</th><th>D MB/s</th><th>Name</th><th>C Mem</th><th>D Mem</th><th>File</th></tr></thead><tbody>\n"); 
+      fprintf(f,"<h3>TurboBench: Compressor Benchmark</h3><table id='myTable' class='tablesorter' style=\"width:35%%\"><thead><tr><th>C Size</th><th>ratio%%</th><th>C MB/s</th><th>D MB/s</th><th>Name</th><th>C Mem</th><th>D Mem</th><th>C RSS</th><th>D RSS</th><th>C PF</th><th>D PF</th><th>File</th></tr></thead><tbody>\n"); 
       break;
     case FMT_MARKDOWN: 
       fprintf(f,"|C Size|ratio%|C MB/s|D MB/s|Name|File|\n|--------:|-----:|--------:|--------:|----------------|----------------|\n"); 
@@ -642,10 +936,10 @@ void plugprt(struct plug *plug, long long totinlen, char *finame, int fmt, doubl
         plug->len, ratio, c?"<b>":"", tc, c?"</b>":"",  d?"<b>":"", td, d?"</b>":"", n?"<b>":"", name, n?"</b>":"", finame); 
       break;
     case FMT_HTML:     
-      fprintf(f, "<tr><td align=\"right\">%11"PRId64"</td><td align=\"right\">%5.1f</td><td align=\"right\">%s%8.2f%s</td><td align=\"right\">%s%8.2f%s</td><td>%s%-16s%s</td><td align=\"right\">%"PRId64"</td><td align=\"right\">%"PRId64"</td><td>%s</td></tr>\n",
+      fprintf(f, "<tr><td align=\"right\">%11lld</td><td align=\"right\">%5.1f</td><td align=\"right\">%s%8.2f%s</td><td align=\"right\">%s%8.2f%s</td><td>%s%-16s%s</td><td align=\"right\">%lld</td><td align=\"right\">%lld</td><td align=\"right\">%lld</td><td align=\"right\">%lld</td><td align=\"right\">%lld/%lld</td><td align=\"right\">%lld/%lld</td><td>%s</td></tr>\n",
         plug->len, ratio, c?"<b>":"", tc, c?"</b>":"",  d?"<b>":"", td, d?"</b>":"", n?"<b>":"", name, n?"</b>":"", 
 //        SIZE_ROUNDUP(plug->memc, Kb)/Kb, SIZE_ROUNDUP(plug->memd,Kb)/Kb, 
-        plug->memc, plug->memd, 
+        plug->memc, plug->memd, plug->rssc, plug->rssd, plug->pfc, plug->pfmc, plug->pfd, plug->pfmd,
         finame); 
       break;
     case FMT_MARKDOWN: 
@@ -676,24 +970,28 @@ void plugprtph(FILE *f, int fmt) {
   switch(fmt) {
     case FMT_HTML: 
       fprintf(f,"<p><h3>TurboBench: Speedup %s sheet</h3><table id='myTable2' class='tablesorter' style=\"width:80%%\"><thead><tr><th>Name</th>", (speedup&1)?"compression":"decompression");
-      for(i = 0; i < BWSIZE; i++) 
+      for(i = 0; i < bwn; i++) 
         fprintf(f, "<th>%s</th>", bw[i].s);
       fprintf(f, "<td>File"); 
       if(blknum) 
         fprintf(f, " blknum=%d ", blknum);
+      if(spcores > 1 || sppipe) 
+        fprintf(f, " cores=%u%s ", spcores, sppipe?" pipelined":"");
       fprintf(f, "</td></tr></thead><tbody>\n"); 
       break;
     case FMT_MARKDOWN: 
       fprintf(f,"#### TurboBench: Speedup %s sheet\n\n", (speedup&1)?"compression":"decompression");
       fprintf(f, "|Name"); 
-      for(i = 0; i < BWSIZE; i++) 
+      for(i = 0; i < bwn; i++) 
         fprintf(f, "|%s", bw[i].s);
       fprintf(f, "|File"); 
       if(blknum) 
         fprintf(f, " blknum=%d ", blknum);
+      if(spcores > 1 || sppipe) 
+        fprintf(f, " cores=%u%s ", spcores, sppipe?" pipelined":"");
       fprintf(f, "|\n"); 
       fprintf(f, "|-------------");
-      for(i = 0; i < BWSIZE; i++) 
+      for(i = 0; i < bwn; i++) 
         fprintf(f, "|---------:");
       fprintf(f, "|-------------|\n"); 
       break;
@@ -702,24 +1000,38 @@ void plugprtph(FILE *f, int fmt) {
       fprintf(f,"[CODE][B]\n"); 
     default: 
       fprintf(f,"Name           ");
-      for(i = 0; i < BWSIZE; i++) 
+      for(i = 0; i < bwn; i++) 
         fprintf(f, "%10s", bw[i].s);
       if(blknum) 
         fprintf(f, " blknum=%d ", blknum);
+      if(spcores > 1 || sppipe) 
+        fprintf(f, " cores=%u%s ", spcores, sppipe?" pipelined":"");
       fprintf(f, "\n"); 
     if(fmt == FMT_VBULLETIN) 
       fprintf(f,"[/B]\n"); 
   }
 }
 
-static inline double spmbs(double td, long long len, int i, long long totinlen) { 
-  double t = td + len*TM_T/(double)bw[i].bw + blknum*(bw[i].rtt*1000.0); 
-  return TMBS(totinlen,t); 
+static inline double sptime(double td, long long len, int i, unsigned nb) {  // transfer + decompression time in us for nb blocks
+  struct bandw *b = &bw[i]; 
+  unsigned q = b->conc?b->conc:1, c = min(spcores, nb), r = bw != bw_?nb:blknum; // requests: one per block with -H profiles, built-in table unchanged
+  double tt = len*TM_T/(double)b->bw + ((r+q-1)/q)*(b->rtt*1000.0 + b->ovh), tc = td/c;
+  return sppipe?max(tt,tc) + min(tt,tc)/nb:tt + tc;               // pipelined: the shorter stage overlaps except for one block
 }
 
-//static inline double spdup(double td, long long len, int i, long long totinlen) { double t = td + len*TM_T/(double)bw[i].bw + blknum*(bw[i].rtt*1000.0); return ((double)totinlen*TM_T*100.0/t)/(double)bw[i].bw;}
-static inline double spdup(double td, long long len, int i, long long totinlen) { 
-  return (double)totinlen*100.0 / ((double)len + ((td+blknum*bw[i].rtt*1000.0)/TM_T)*(double)bw[i].bw ); 
+static unsigned spbsize;                                    // -b block size, results read from *.tbb have no block size
+
+static inline unsigned spblk(struct plug *plug, long long totinlen) { 
+  unsigned bs = plug->blksize?plug->blksize:spbsize;
+  return blknum?blknum:(bs && totinlen > bs?(totinlen + bs-1)/bs:1); 
+}
+
+static inline double spmbs(double td, long long len, int i, long long totinlen, unsigned nb) { 
+  return TMBS(totinlen, sptime(td, len, i, nb)); 
+}
+
+static inline double spdup(double td, long long len, int i, long long totinlen, unsigned nb) { 
+  return (double)totinlen*TM_T*100.0 / (sptime(td, len, i, nb)*(double)bw[i].bw); 
 }
 
 void plugprtp(struct plug *plug, long long totinlen, char *finame, int fmt, int speedup, FILE *f) {
@@ -734,7 +1046,7 @@ void plugprtp(struct plug *plug, long long totinlen, char *finame, int fmt, int
   else 
     fprintf(f, "%-16s", name);															 
 
-  for(i = 0; i < BWSIZE; i++) {
+  for(i = 0; i < bwn; i++) {
     switch(fmt) {
       case FMT_HTMLT: 
       case FMT_HTML: 
@@ -746,16 +1058,16 @@ void plugprtp(struct plug *plug, long long totinlen, char *finame, int fmt, int
     }
     switch(speedup) {
       case SP_TRANSFERD: 
-        fprintf(f,"%9.3f ", spmbs(plug->td, plug->len, i, totinlen)); 
+        fprintf(f,"%9.3f ", spmbs(plug->td, plug->len, i, totinlen, spblk(plug, totinlen))); 
         break;
       case SP_SPEEDUPD:  
-        fprintf(f,"%9d ", (int)(spdup(plug->td, plug->len, i, totinlen)+0.5)); 
+        fprintf(f,"%9d ", (int)(spdup(plug->td, plug->len, i, totinlen, spblk(plug, totinlen))+0.5)); 
         break;
       case SP_TRANSFERC: 
-        fprintf(f,"%9.3f ", spmbs(plug->td, plug->len, i, totinlen)); 
+        fprintf(f,"%9.3f ", spmbs(plug->td, plug->len, i, totinlen, spblk(plug, totinlen))); 
         break;
       case SP_SPEEDUPC:  
-        fprintf(f,"%9d ", (int)(spdup(plug->td, plug->len, i, totinlen)+0.5)); 
+        fprintf(f,"%9d ", (int)(spdup(plug->td, plug->len, i, totinlen, spblk(plug, totinlen))+0.5)); 
         break;
     }
     switch(fmt) {
@@ -804,23 +1116,23 @@ void plugplot(struct plug *plug, long long totinlen, int fmt, int speedup, char
   strcat(s,name); strcat(s,",");
 
   fprintf(f, "var %s = { x: [", name);							
-  for(i = 0; i < BWSIZE; i++) 
-    fprintf(f,"%llu%s", bw[i].bw, i+1 < BWSIZE?",":""); 			
+  for(i = 0; i < bwn; i++) 
+    fprintf(f,"%llu%s", bw[i].bw, i+1 < bwn?",":""); 			
   fprintf(f, "],\ny: [");							
 
-  for(i = 0; i < BWSIZE; i++)  				
+  for(i = 0; i < bwn; i++)  				
     switch(speedup) {
       case SP_TRANSFERD: 
-        fprintf(f,"%9.3f%s",    spmbs(plug->td, plug->len, i, totinlen), i+1 < BWSIZE?",":""); 
+        fprintf(f,"%9.3f%s",    spmbs(plug->td, plug->len, i, totinlen, spblk(plug, totinlen)), i+1 < bwn?",":""); 
         break;
       case SP_SPEEDUPD:  
-        fprintf(f,"%9d%s", (int)(spdup(plug->td, plug->len, i, totinlen)+0.5), i+1 < BWSIZE?",":""); 
+        fprintf(f,"%9d%s", (int)(spdup(plug->td, plug->len, i, totinlen, spblk(plug, totinlen))+0.5), i+1 < bwn?",":""); 
         break;
       case SP_TRANSFERC: 
-        fprintf(f,"%9.3f%s",    spmbs(plug->tc, plug->len, i, totinlen), i+1 < BWSIZE?",":""); 
+        fprintf(f,"%9.3f%s",    spmbs(plug->tc, plug->len, i, totinlen, spblk(plug, totinlen)), i+1 < bwn?",":""); 
         break;
       case SP_SPEEDUPC:  
-        fprintf(f,"%9d%s", (int)(spdup(plug->tc, plug->len, i, totinlen)+0.5), i+1 < BWSIZE?",":""); 
+        fprintf(f,"%9d%s", (int)(spdup(plug->tc, plug->len, i, totinlen, spblk(plug, totinlen))+0.5), i+1 < bwn?",":""); 
         break;
     }															   
   fprintf(f, "],\ntype: 'scatter',\nmode: 'lines+markers',\nline: {shape: 'spline'},\nname: '%s'\n};\n", name);							 
@@ -977,40 +1289,463 @@ int plugprts(struct plug *plug, int k, char *finame, int xstdout, unsigned long
     }
   }
   plugprtf(fo, fmt);
-  fclose(fo);
+  if(fo != stdout) fclose(fo); else fflush(fo);
 } 
 
+//----------------------------------- JSON Lines results --------------------------------------------------------------------------
+// one object per codec and run appended to 'file.jsonl': all metrics, -k run samples, percentiles and the environment
+  #if !defined(_WIN32)
+#include <sys/utsname.h>
+  #endif
+  #ifndef TB_FLAGS
+#define TB_FLAGS ""
+  #endif
+  #ifndef TB_BUILD
+#define TB_BUILD __DATE__ " " __TIME__                      // build timestamp, or a git hash with make TB_BUILD=...
+  #endif
+static int jsonout;
+
+static void jstr(FILE *f, char *key, const char *s) { 
+  fprintf(f, "\"%s\":\"", key);
+  for(; *s; s++) 
+    if(*s == '"' || *s == '\\') fprintf(f, "\\%c", *s); 
+    else if((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", *s); 
+    else fputc(*s, f);
+  fputc('"', f);
+}
+
+static char *sysline(char *fname, char *key, char *s, int n) { // first line of 'fname' or value of "key : value" 
+  FILE *f = fopen(fname, "r"); char line[512],*q; 
+  s[0] = 0;
+  if(!f) return s;
+  while(fgets(line, sizeof(line), f)) 
+    if(!key || !strncmp(line, key, strlen(key))) {
+      q = key?strchr(line, ':'):NULL; q = q?q+1:line; 
+      while(*q == ' ' || *q == '\t') q++;
+      strncpy(s, q, n-1); s[n-1] = 0; 
+      if((q = strchr(s, '\n'))) *q = 0;
+      break;
+    }
+  fclose(f);
+  return s;
+}
+
+static void jsonenv(FILE *f) {
+  char s[256]; 
+  fprintf(f, "\"env\":{");
+    #if !defined(_WIN32)
+  struct utsname u; 
+  if(!uname(&u)) { jstr(f, "host", u.nodename); fputc(',', f); jstr(f, "kernel", u.release); fputc(',', f); jstr(f, "arch", u.machine); fputc(',', f); }
+  jstr(f, "cpu", sysline("/proc/cpuinfo", "model name", s, sizeof(s))); fputc(',', f);
+  jstr(f, "governor", sysline("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", NULL, s, sizeof(s))); fputc(',', f);
+    #endif
+    #ifdef __VERSION__
+  jstr(f, "compiler", __VERSION__); 
+    #elif defined(_MSC_VER)
+  sprintf(s, "msvc %d", _MSC_VER); jstr(f, "compiler", s);
+    #else
+  jstr(f, "compiler", "");
+    #endif
+  fputc(',', f); jstr(f, "flags", TB_FLAGS); 
+  fputc(',', f); jstr(f, "build", TB_BUILD); 
+  fprintf(f, "}");
+}
+
+static int dblcmp(const void *a, const void *b) { double x = *(double *)a, y = *(double *)b; return x < y?-1:(x > y?1:0); }
+
+static void jsonspeed(FILE *f, char *key, double *t, int n, long long totinlen) { // percentiles of the run speeds (MB/s)
+  double v[KSMAX]; int i;
+  if(!n) return;
+  for(i = 0; i < n; i++) v[i] = TMBS(totinlen, t[i]);
+  qsort(v, n, sizeof(v[0]), dblcmp);
+  fprintf(f, ",\"%s\":{\"min\":%.2f,\"p10\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"max\":%.2f}", key, v[0], v[n/10], v[n/2], v[(n*9)/10], v[n-1]);
+}
+
+void plugjson(struct plug *plugt, int k, char *finame, long long totinlen) {
+  char s[1024],tms[20]; struct plug *p; int i;
+  time_t tm; time(&tm); strftime(tms, sizeof(tms), "%Y-%m-%d.%H:%M:%S", localtime(&tm));
+  sprintf(s, "%s.jsonl", finame);
+  FILE *f = fopen(s, "a"); if(!f) { perror(s); return; }
+  for(p = plugt; p < plugt+k; p++) {
+    fputc('{', f);          jstr(f, "dataset", finame);
+    fprintf(f, ",\"size\":%lld,", totinlen); jstr(f, "codec", p->s);
+    fprintf(f, ",\"level\":%d,", p->lev);          jstr(f, "param", p->prm);
+    fprintf(f, ",\"csize\":%lld,\"ctime\":%.6f,\"dtime\":%.6f,\"cspeed\":%.2f,\"dspeed\":%.2f", p->len, p->tc, p->td, TMBS(totinlen, p->tc), TMBS(totinlen, p->td));
+    fprintf(f, ",\"csamples\":[");
+    for(i = 0; i < p->ks; i++) 
+      fprintf(f, "%s%.6f", i?",":"", p->tcs[i]); 
+    fprintf(f, "],\"dsamples\":[");
+    for(i = 0; i < p->ks; i++) 
+      fprintf(f, "%s%.6f", i?",":"", p->tds[i]); 
+    fprintf(f, "]");
+    jsonspeed(f, "cpct", p->tcs, p->ks, totinlen);
+    jsonspeed(f, "dpct", p->tds, p->ks, totinlen);
+    fprintf(f, ",\"cmem\":%lld,\"dmem\":%lld,\"crss\":%lld,\"drss\":%lld,\"cpf\":%lld,\"dpf\":%lld,\"cpfm\":%lld,\"dpfm\":%lld,\"err\":%d,", 
+               p->memc, p->memd, p->rssc, p->rssd, p->pfc, p->pfd, p->pfmc, p->pfmd, p->err); 
+    jstr(f, "time", tms); fputc(',', f);
+    jsonenv(f);
+    fprintf(f, "}\n");
+  }
+  fclose(f);
+}
+
+static char *jget(char *line, char *key) {                  // value after "key": or NULL
+  char k[64],*q; 
+  sprintf(k, "\"%s\":", key);
+  return (q = strstr(line, k))?q+strlen(k):NULL;
+}
+
+static char *jgets(char *line, char *key, char *s, int n) {
+  char *q = jget(line, key); int i = 0;
+  s[0] = 0;
+  if(!q || *q++ != '"') return s;
+  for(; *q && *q != '"' && i < n-1; q++) { if(*q == '\\' && q[1]) q++; s[i++] = *q; }
+  s[i] = 0;
+  return s;
+}
+
+static long long jgetl(char *line, char *key) { char *q = jget(line, key); return q?strtoll(q, NULL, 10):0; }
+static double    jgetd(char *line, char *key) { char *q = jget(line, key); return q?strtod(q, NULL):0; }
+
+static int jgeta(char *line, char *key, double *a) {
+  char *q = jget(line, key); int n = 0;
+  if(!q || *q++ != '[') return 0;
+  while(*q && *q != ']' && n < KSMAX) { a[n++] = strtod(q, &q); if(*q == ',') q++; }
+  return n;
+}
+
+// codec entry of 'name', pipelines (ex. "delta:32+lz4:9") are registered on the fly
+static struct plugs *plugfind(char *name) { 
+  int i;
+  if(strchr(name, '+')) 
+    plugpipe(name);
+  for(i = 0; plugs[i].id >= 0; i++) 
+    if(!strcmp(name, plugs[i].s)) 
+      return &plugs[i];
+  return NULL;
+}
+
+// read 'file.jsonl'. The last line of a codec/level/parameter replaces older lines 
+int plugreadj(struct plug *plug, char *finame, long long *totinlen) {
+  char name[NAMELEN+1], line[8192]; 
+  struct plug *p, *g; struct plugs *gs;
+  FILE *fi = fopen(finame, "r");
+  if(!fi) return -1;
+  for(p = plug; fgets(line, sizeof(line), fi) && p < plug+254;) {
+    if(!jget(line, "codec")) continue;
+    jgets(line, "codec", name, sizeof(name));
+    if(!(gs = plugfind(name))) continue;
+    int  lev = jgetl(line, "level"); char prm[PRMLEN+1]; 
+    jgets(line, "param", prm, sizeof(prm));
+    for(g = plug; g < p && !(g->id == gs->id && g->lev == lev && !strcmp(g->prm, prm)); g++);
+    if(g == p) p++;
+    memset(g, 0, sizeof(g[0]));
+    g->s   = gs->s; 
+    g->id  = gs->id; 
+    g->lev = lev; 
+    strcpy(g->prm, prm);
+    *totinlen = jgetl(line, "size");
+    g->len  = jgetl(line, "csize");  g->tc   = jgetd(line, "ctime"); g->td   = jgetd(line, "dtime");
+    g->memc = jgetl(line, "cmem");   g->memd = jgetl(line, "dmem");
+    g->rssc = jgetl(line, "crss");   g->rssd = jgetl(line, "drss");
+    g->pfc  = jgetl(line, "cpf");    g->pfd  = jgetl(line, "dpf");   g->pfmc = jgetl(line, "cpfm"); g->pfmd = jgetl(line, "dpfm");
+    g->err  = jgetl(line, "err");
+    jgets(line, "time", g->tms, sizeof(g->tms));
+    g->ks   = jgeta(line, "csamples", g->tcs); 
+    jgeta(line, "dsamples", g->tds);
+  }
+  fclose(fi);
+  return p - plug;
+}
+
+//----------------------------------- Results store ------------------------------------------------------------------------------
+// append-only file 'turbobench.tbs' per dataset directory with fixed size records + sorted index 'turbobench.tbi'
+// index key: dataset hash (high 32 bits) | hash(codec,level,param,host,build). The index is rebuilt when records were appended
+#define TBS_MAGIC 0x31534254                                // "TBS1"
+#define TBI_MAGIC 0x31494254                                // "TBI1"
+#define TBS_NAME  "turbobench.tbs"
+#define TBI_NAME  "turbobench.tbi"
+static char *tbsquery; static int tbsout;
+
+struct tbsrec {
+  uint64_t key;
+  int64_t  tm, size, csize, cmem, dmem, crss, drss, cpf, dpf, cpfm, dpfm;  // page faults: minor, major
+  double   ctime, dtime;
+  int32_t  lev, err;
+  char     dataset[64], codec[NAMELEN+1], prm[PRMLEN+1], host[32], cpu[64], build[128];  // build: TB_BUILD + TB_FLAGS
+};
+struct tbsidx { uint64_t key; uint32_t rec, pad; };
+
+static uint32_t fnv32(const char *s, uint32_t h) { while(*s) h = (h ^ (unsigned char)*s++) * 16777619u; return h; }
+
+static uint64_t tbskey(struct tbsrec *r) { 
+  char lev[16]; uint32_t h = fnv32(r->codec, 2166136261u); sprintf(lev, "\t%d\t", r->lev);
+  h = fnv32(r->build, fnv32(r->host, fnv32(r->prm, fnv32(lev, h))));
+  return (uint64_t)fnv32(r->dataset, 2166136261u) << 32 | h;
+}
+
+static void tbspath(char *s, char *dir, char *name) { sprintf(s, "%s%s%s", dir, *dir?"/":"", name); }
+
+void tbsadd(struct plug *plugt, int k, char *dir, char *finame, long long totinlen) {
+  struct tbsrec r; struct plug *p; char s[1024],cpu[256]; 
+  tbspath(s, dir, TBS_NAME);
+  FILE *f = fopen(s, "ab"); if(!f) { perror(s); return; }
+  if(!ftello(f)) { uint32_t h[2] = { TBS_MAGIC, sizeof(r) }; fwrite(h, sizeof(h), 1, f); }
+  for(p = plugt; p < plugt+k; p++) {
+    memset(&r, 0, sizeof(r));
+    strncpy(r.dataset, finame, sizeof(r.dataset)-1); strncpy(r.codec, p->s, sizeof(r.codec)-1); strcpy(r.prm, p->prm);
+      #if !defined(_WIN32)
+    struct utsname u; if(!uname(&u)) snprintf(r.host, sizeof(r.host), "%.*s", (int)sizeof(r.host)-1, u.nodename);
+    strncpy(r.cpu, sysline("/proc/cpuinfo", "model name", cpu, sizeof(cpu)), sizeof(r.cpu)-1);
+      #endif
+    snprintf(r.build, sizeof(r.build), "%s %s", TB_BUILD, TB_FLAGS);
+    r.lev  = p->lev;  r.err  = p->err;  r.tm   = time(NULL);
+    r.size = totinlen; r.csize = p->len; r.ctime = p->tc; r.dtime = p->td;
+    r.cmem = p->memc; r.dmem = p->memd; r.crss = p->rssc; r.drss = p->rssd; r.cpf = p->pfc; r.dpf = p->pfd; r.cpfm = p->pfmc; r.dpfm = p->pfmd;
+    r.key  = tbskey(&r);
+    fwrite(&r, sizeof(r), 1, f);
+  }
+  fclose(f);
+}
+
+static int tbsidxcmp(const void *a, const void *b) { 
+  const struct tbsidx *x = (const struct tbsidx *)a, *y = (const struct tbsidx *)b; 
+  return x->key < y->key?-1:(x->key > y->key?1:(x->rec < y->rec?-1:(x->rec > y->rec)));
+}
+
+// load the index of 'n' records, rebuild + save if stale
+static struct tbsidx *tbsidxload(char *dir, FILE *fd, uint32_t n) {
+  char s[1024]; uint32_t h[2] = {0}, i; 
+  struct tbsidx *x = (struct tbsidx *)malloc((n+1)*sizeof(x[0])); if(!x) die("malloc error\n");
+  tbspath(s, dir, TBI_NAME);
+  FILE *f = fopen(s, "rb");
+  if(f && fread(h, sizeof(h), 1, f) == 1 && h[0] == TBI_MAGIC && h[1] == n && fread(x, sizeof(x[0]), n, f) == n) { fclose(f); return x; }
+  if(f) fclose(f);
+  struct tbsrec r;
+  fseeko(fd, 2*sizeof(uint32_t), SEEK_SET);
+  for(i = 0; i < n && fread(&r, sizeof(r), 1, fd) == 1; i++) x[i].key = r.key, x[i].rec = i, x[i].pad = 0;
+  qsort(x, n, sizeof(x[0]), tbsidxcmp);
+  if((f = fopen(s, "wb"))) { h[0] = TBI_MAGIC; h[1] = n; fwrite(h, sizeof(h), 1, f); fwrite(x, sizeof(x[0]), n, f); fclose(f); } 
+  return x;
+}
+
+static char *tbsflt(char *q, char *key, char *s) {         // value of "key=value" in query q
+  char *p = q; int l = strlen(key);
+  s[0] = 0;
+  while((p = strstr(p, key))) {
+    if((p == q || p[-1] == ',') && p[l] == '=') { 
+      int i = 0; p += l+1; 
+      while(*p && *p != ',' && i < 63) s[i++] = *p++; 
+      s[i] = 0; 
+      return s;
+    }
+    p += l;
+  }
+  return NULL;
+}
+
+static int tbsreccmp(const void *a, const void *b) {        // dataset, host, build, time
+  const struct tbsrec *x = (const struct tbsrec *)a, *y = (const struct tbsrec *)b; int c;
+  if((c = strcmp(x->dataset, y->dataset)) || (c = strcmp(x->host, y->host)) || (c = strcmp(x->build, y->build))) return c;
+  return x->tm < y->tm?-1:(x->tm > y->tm);
+}
+
+// query 'dataset=,codec=,level=,param=,host=,build=' (all optional) and print the latest result of each codec per dataset/host/build
+int tbsqry(char *dir, char *q, int xstdout, int fmt, char *rem) {
+  char s[1024], ds[64], cs[64], ls[64], ps[64], hs[64], bs[64]; 
+  char *fds = tbsflt(q, "dataset", ds), *fcs = tbsflt(q, "codec", cs), *fls = tbsflt(q, "level", ls), *fps = tbsflt(q, "param", ps), *fhs = tbsflt(q, "host", hs), *fbs = tbsflt(q, "build", bs);
+  uint32_t h[2], n, i, j, lo, hi, m = 0; 
+  tbspath(s, dir, TBS_NAME);
+  FILE *f = fopen(s, "rb"); if(!f) { perror(s); return -1; }
+  if(fread(h, sizeof(h), 1, f) != 1 || h[0] != TBS_MAGIC || h[1] != sizeof(struct tbsrec)) die("'%s': not a results store or different version\n", s);
+  fseeko(f, 0, SEEK_END); n = (ftello(f) - sizeof(h)) / sizeof(struct tbsrec);
+  struct tbsidx *x = tbsidxload(dir, f, n);
+  lo = 0; hi = n;
+  if(fds) {                                                 // key range of the dataset
+    uint64_t k0 = (uint64_t)fnv32(fds, 2166136261u) << 32, k1 = k0 | 0xffffffffull; uint32_t l = 0, r = n;
+    while(l < r) { uint32_t c = (l+r)/2; if(x[c].key < k0) l = c+1; else r = c; } lo = l; 
+    for(r = n; l < r; ) { uint32_t c = (l+r)/2; if(x[c].key <= k1) l = c+1; else r = c; } hi = l;
+  }
+  struct tbsrec *rs = (struct tbsrec *)malloc((hi-lo+1)*sizeof(rs[0])); if(!rs) die("malloc error\n");
+  for(i = lo; i < hi; i++) {
+    struct tbsrec *r = &rs[m];
+    fseeko(f, sizeof(h) + (uint64_t)x[i].rec*sizeof(*r), SEEK_SET);
+    if(fread(r, sizeof(*r), 1, f) != 1) continue;
+    if((fds && strcmp(r->dataset, fds)) || (fcs && strcasecmp(r->codec, fcs)) || (fls && r->lev != atoi(fls)) || (fps && strcmp(r->prm, fps)) || 
+       (fhs && strcmp(r->host, fhs))    || (fbs && !strstr(r->build, fbs))) continue;
+    m++;																					if(verbose > 1) printf("%s\t%s\t%s\t%s\t%d%s\t%"PRId64"\t%.2f\t%.2f\t%s\n", r->dataset, r->host, r->cpu, r->codec, r->lev, r->prm, r->csize, TMBS(r->size, r->ctime), TMBS(r->size, r->dtime), r->build);
+  }
+  fclose(f); free(x);
+  qsort(rs, m, sizeof(rs[0]), tbsreccmp);
+  for(i = 0; i < m; i = j) {                                // one report per dataset/host/build 
+    int k = 0;
+    for(j = i; j < m && !strcmp(rs[j].dataset, rs[i].dataset) && !strcmp(rs[j].host, rs[i].host) && !strcmp(rs[j].build, rs[i].build); j++) {
+      struct plug *p, *g = NULL; int c;
+      for(p = plugt; p < plugt+k; p++) 
+        if(!strcmp(p->s, rs[j].codec) && p->lev == rs[j].lev && !strcmp(p->prm, rs[j].prm)) { g = p; break; }
+      if(!g) {                                              // records sorted by time: newer replaces older
+        if(k >= 254) continue; 
+        g = &plugt[k++]; memset(g, 0, sizeof(g[0]));
+        g->s = strdup(rs[j].codec); 
+      }
+      for(c = 0; plugs[c].id >= 0 && strcmp(plugs[c].s, rs[j].codec); c++); 
+      g->id   = plugs[c].id >= 0?plugs[c].id:P_NULL;
+      g->lev  = rs[j].lev; strcpy(g->prm, rs[j].prm);
+      g->len  = rs[j].csize; g->tc = rs[j].ctime; g->td = rs[j].dtime; g->memc = rs[j].cmem; g->memd = rs[j].dmem; g->err = rs[j].err;
+      g->rssc = rs[j].crss; g->rssd = rs[j].drss; g->pfc = rs[j].cpf; g->pfd = rs[j].dpf; g->pfmc = rs[j].cpfm; g->pfmd = rs[j].dpfm;
+      time_t tm = rs[j].tm; strftime(g->tms, sizeof(g->tms), "%Y-%m-%d.%H:%M:%S", localtime(&tm));
+    }
+    if(fmt == FMT_TEXT || !fmt) printf("%s  %s  %s  %s\n", rs[i].dataset, rs[i].host, rs[i].cpu, rs[i].build);
+    sprintf(s, "%s.%s", rs[i].dataset, rs[i].host);
+    plugprts(plugt, k, s, fmt?xstdout:0, rs[i].size, fmt?fmt:FMT_TEXT, rem);  // text: stdout, other formats: file or -o
+    while(k) free(plugt[--k].s);
+  }
+  free(rs);
+  return m;
+}
+
 int plugread(struct plug *plug, char *finame, long long *totinlen) {
-  char s[256],name[33];
-  struct plug *p=plug;
-  FILE *fi = fopen(finame, "r"); 
+  char line[4096],*f[17],*q;
+  struct plug *p=plug; struct plugs *gs;
+  q = strrchr(finame, '.');
+  if(q && !strcmp(q, ".jsonl")) 
+    return plugreadj(plug, finame, totinlen);
+  FILE *fi = fopen(finame, "r");
   if(!fi) return -1;
 
-  fgets(s, 255, fi);
-  for(p = plug;;) { 
-    p->tms[0] = 0;
-    int i = fscanf(fi, "%s\t%"PRId64"\t%"PRId64"\t%lf\t%lf\t%s\t%d\t%s\t%"PRId64"\t%"PRId64"\t%s\n", s, totinlen, &p->len, &p->td, &p->tc, name, &p->lev, p->prm, &p->memc, &p->memd, p->tms); 
-    if(i != 11)
+  fgets(line, sizeof(line), fi);
+  for(p = plug; fgets(line, sizeof(line), fi) && p < plug+254;) {
+    int i, n;
+    p->tms[0] = 0; p->ks = 0; p->err = 0;
+    p->rssc = p->rssd = p->pfc = p->pfd = p->pfmc = p->pfmd = 0;                    // optional columns: not in old .tbb files
+    line[strcspn(line, "\r\n")] = 0;
+    for(n = 0, q = line; n < 17 && q; n++) {                // tab separated: dataset paths and pipeline names of any length
+      f[n] = q; 
+      if((q = strchr(q, '\t'))) *q++ = 0; 
+    }
+    if(n < 11)
       break;
+    *totinlen = atoll(f[1]); p->len = atoll(f[2]); p->td = atof(f[3]); p->tc = atof(f[4]); p->lev = atoi(f[6]);
+    strncpy(p->prm, f[7], PRMLEN);                 p->prm[PRMLEN] = 0;
+    strncpy(p->tms, f[10], sizeof(p->tms)-1);      p->tms[sizeof(p->tms)-1] = 0;
+    p->memc = atoll(f[8]); p->memd = atoll(f[9]);
+    long long *o[] = { &p->rssc, &p->rssd, &p->pfc, &p->pfd, &p->pfmc, &p->pfmd };
+    for(i = 11; i < n; i++) 
+      *o[i-11] = atoll(f[i]);
     if(p->prm[0]=='?') 
       p->prm[0]=0;
-    for(i = 0; plugs[i].id >=0; i++) 
-      if(!strcmp(name, plugs[i].s)) { 
-        p->s  = plugs[i].s; 
-        p->id = plugs[i].id; 											if(verbose>1) { fprintf(stdout, "%s\t%"PRId64"\t%"PRId64"\t%.6f\t%.6f\t%s\t%d%s\t%s\t%"PRId64"\t%"PRId64"\n", s, *totinlen, p->len, p->td, p->tc, p->s, p->lev, p->prm, p->tms, p->memc, p->memd); fflush(stdout); }
-        p++;
-        break; 
-      } 																	      		
+    if(!(gs = plugfind(f[5]))) 
+      continue;
+    p->s  = gs->s; 
+    p->id = gs->id; 											if(verbose>1) { fprintf(stdout, "%s\t%lld\t%lld\t%.6f\t%.6f\t%s\t%d%s\t%s\t%lld\t%lld\t%lld\t%lld\t%lld/%lld\t%lld/%lld\n", f[0], *totinlen, p->len, p->td, p->tc, p->s, p->lev, p->prm, p->tms, p->memc, p->memd, p->rssc, p->rssd, p->pfc, p->pfmc, p->pfd, p->pfmd); fflush(stdout); }
+    p++;
   }
   fclose(fi);
   return p - plug;
 }
 
+//----------------------------------- A/B ---------------------------------------------------------------------------------------
+// Welch t statistic of the speeds (MB/s) over the -k runs: marker '*' |t|>=2, '**' |t|>=3
+static char *abmark(struct plug *a, struct plug *b, long long totinlen, int d) {
+  double ma = 0, mb = 0, va = 0, vb = 0, t; int i, na = a->ks, nb = b->ks;
+  double *ta = d?a->tds:a->tcs, *tb = d?b->tds:b->tcs;
+  if(na < 2 || nb < 2) return "  ";
+  for(i = 0; i < na; i++) ma += TMBS(totinlen, ta[i]); 
+  for(i = 0; i < nb; i++) mb += TMBS(totinlen, tb[i]); 
+  ma /= na; mb /= nb;
+  for(i = 0; i < na; i++) { t = TMBS(totinlen, ta[i]) - ma; va += t*t; } 
+  for(i = 0; i < nb; i++) { t = TMBS(totinlen, tb[i]) - mb; vb += t*t; } 
+  va /= na-1; vb /= nb-1;
+  if(va+vb <= 0) return ma != mb?"**":"  ";
+  t = fabs(ma - mb) / sqrt(va/na + vb/nb);
+  return t >= 3?"**":(t >= 2?"* ":"  ");
+}
+
+// per level deltas of codec B against codec A. ab = "A:B"
+void plugab(struct plug *plugt, int k, char *ab, long long totinlen, FILE *f) {
+  char a[65], *b; struct plug *p,*q; 
+  strncpy(a, ab, 64); a[64] = 0; 
+  if(!(b = strchr(a, ':'))) { fprintf(stderr, "A/B: codecs 'A:B' expected '%s'\n", ab); return; } *b++ = 0;
+  fprintf(f, "\nA/B %s:%s  (delta = B vs A, * |t|>=2, ** |t|>=3 over -k runs)\n", a, b);
+  fprintf(f, "  Level   C Size A   C Size B  size%%    C MB/s A   C MB/s B  delta%%       D MB/s A   D MB/s B  delta%%\n");
+  for(p = plugt; p < plugt+k; p++) {
+    if(strcasecmp(p->s, a)) continue;
+    for(q = plugt; q < plugt+k; q++) 
+      if(!strcasecmp(q->s, b) && q->lev == p->lev && !strcmp(q->prm, p->prm)) {
+        double ca = TMBS(totinlen, p->tc), cb = TMBS(totinlen, q->tc), da = TMBS(totinlen, p->td), db = TMBS(totinlen, q->td);
+        char lev[32]; sprintf(lev, "%d%s", p->lev, p->prm);
+        fprintf(f, "%7s %10lld %10lld %+6.2f  %10.2f %10.2f %+7.2f %s  %10.2f %10.2f %+7.2f %s\n", lev, p->len, q->len, p->len?(double)(q->len - p->len)*100.0/p->len:0.0,
+                   ca, cb, ca>0?(cb-ca)*100.0/ca:0.0, abmark(p, q, totinlen, 0), 
+                   da, db, da>0?(db-da)*100.0/da:0.0, abmark(p, q, totinlen, 1));
+        break;
+      }
+  }
+}
+
+//----------------------------------- Regression gate ---------------------------------------------------------------------------
+// compare with a baseline .tbb: "file.tbb[,c%,d%,r%,m%]" thresholds for compression speed, decompression speed, compressed size, memory
+struct plug plugb[255];
+
+static int regchk(FILE *f, struct plug *p, char *metric, double vb, double vp, double thr, int bigger, int sig) { // bigger: larger value is worse
+  double d = vb?(vp - vb)*100.0/vb:0.0; 
+  int    r = (bigger?d > thr:d < -thr) && sig;
+  if(r || verbose > 1) {
+    fprintf(f, "%-16s %3d%-6s %-8s %12.2f %12.2f %+8.2f%% %s\n", p->s, p->lev, p->prm, metric, vb, vp, d, r?"REGRESSION":(sig?"":"(not significant)"));
+  }
+  return r;
+}
+
+// return number of regressions, -1 if the baseline is missing or no codec matches the baseline
+int plugcmp(char *base, struct plug *plugt, int k, long long totinlen, FILE *f) {
+  char   s[256],*q; 
+  double thc = 5, thd = 5, thr = 0.1, thm = 10;
+  long long btotinlen; int gk,nr = 0,nm = 0;
+  struct plug *p,*b;
+  strncpy(s, base, 255); s[255] = 0;
+  if((q = strchr(s, ','))) { *q++ = 0; sscanf(q, "%lf,%lf,%lf,%lf", &thc, &thd, &thr, &thm); }
+  if((gk = plugread(plugb, s, &btotinlen)) <= 0) { fprintf(stderr, "baseline '%s' not found\n", s); return -1; }
+  if(btotinlen != totinlen) fprintf(stderr, "baseline '%s': different input size %lld <> %lld\n", s, btotinlen, totinlen);
+  fprintf(f, "\nRegression gate: baseline '%s' thresholds C %.2f%% D %.2f%% size %.2f%% mem %.2f%%\n", s, thc, thd, thr, thm);
+  for(p = plugt; p < plugt+k; p++) {
+    for(b = plugb; b < plugb+gk; b++) 
+      if(!strcmp(b->s, p->s) && b->lev == p->lev && !strcmp(b->prm, p->prm)) break;
+    if(b >= plugb+gk) { fprintf(f, "%-16s %3d%-6s not in baseline\n", p->s, p->lev, p->prm); continue; }
+    nm++;
+    double sc = 0, sd = 0; int i;                           // fastest run: the baseline must be faster than all runs (-k#)
+    for(i = 0; i < p->ks; i++) { sc = max(sc, TMBS(totinlen, p->tcs[i])); sd = max(sd, TMBS(totinlen, p->tds[i])); }
+    double bc = TMBS(btotinlen, b->tc), bd = TMBS(btotinlen, b->td);
+    nr += regchk(f, p, "C MB/s", bc, TMBS(totinlen, p->tc), thc, 0, p->ks < 2 || bc > sc);
+    if(b->td > 0 && p->td > 0 && cmp)
+      nr += regchk(f, p, "D MB/s", bd, TMBS(totinlen, p->td), thd, 0, p->ks < 2 || bd > sd);
+    nr += regchk(f, p, "C Size", b->len, p->len, thr, 1, 1);
+    nr += regchk(f, p, "C Mem",  b->memc, p->memc, thm, 1, p->memc - b->memc > 64*1024);
+    nr += regchk(f, p, "D Mem",  b->memd, p->memd, thm, 1, p->memd - b->memd > 64*1024);
+  }
+  fprintf(f, "%d regression(s) in %d codec(s) compared\n", nr, nm);
+  if(!nm) { fprintf(stderr, "baseline '%s': no codec compared\n", s); return -1; }
+  return nr;
+}
+
 //----------------------------------- Benchmark -----------------------------------------------------------------------------
-static int mcpy, mode, tincx, fuzz;
+static int mcpy, mode, tincx, fuzz, vhash;
+static int ovhd; static unsigned ovhbsize, ovhlen; static double ovhtc, ovhtd;  // harness overhead per file measured with the null codec
+#define OVHCOR(__t,__o) (ovhd && plug->id != P_NULL?max((__t)-(__o), (__t)/100):(__t))
+
+unsigned blkcnt(unsigned char *in, unsigned inlen, unsigned bsize) {  // number of codec calls in becomp/bedecomp
+  unsigned char *ip = in; unsigned n = 0, l;
+  if(!mode) return (inlen+bsize-1)/bsize;
+  while(ip+4 <= in+inlen) { 
+    l = ctou32(ip); ip += 4; if(ip+l > in+inlen) l = (in+inlen) - ip;
+    n += (l+bsize-1)/bsize; ip += l; 
+  }
+  return n;
+}
 
 int becomp(unsigned char *_in, unsigned _inlen, unsigned char *_out, unsigned outsize, unsigned bsize, int id, int lev, char *prm) { 
   unsigned char *op,*oe = _out + outsize;
+  size_t   bnd = mode?0:codbound(min(bsize,_inlen), id);  // worst case expansion check
+  unsigned bovf = 0;
+  struct codprm cp; codprmini(&cp, id, lev, prm);
   TMDEF;
   TMBEG('C',tm_repc,tm_Repc);     mempeakinit();                                           
   unsigned char *in,*ip;																							
@@ -1025,7 +1760,8 @@ int becomp(unsigned char *_in, unsigned _inlen, unsigned char *_out, unsigned ou
     for(ip = in, in += inlen; ip < in; ) { 
       unsigned iplen = in - ip; iplen = min(iplen, bsize);       
       bs = (min(bsize, iplen) < (1<<16))?2:4;
-      int oplen = codcomp(ip, iplen, op+bs, oe-(op+bs), id, lev,prm);
+      int oplen = cp.comp(ip, iplen, op+bs, oe-(op+bs), &cp);         MEMPROF_CALL(iplen);
+      if(oplen > 0 && (size_t)oplen > bnd && bnd) bovf++;
       if(oplen <= 0 || oplen >= iplen && mcpy) {
 	    if(mcpy) { memcpy(op+bs, ip, iplen); oplen = iplen; }
 	    else if(oplen <= 0) return 0;
@@ -1036,11 +1772,13 @@ int becomp(unsigned char *_in, unsigned _inlen, unsigned char *_out, unsigned ou
 	  die("Overflow error %llu, %u in lib=%d\n", outsize, (int)(ptrdiff_t)(op - _out), id);      
   }
   TMEND;	
+  if(bovf) fprintf(stderr, "block expansion error: %u blocks larger than the bound %u in lib=%d\n", bovf, (unsigned)bnd, id);
   return op - _out;
 }
 
-int bedecomp(unsigned char *_in, int _inlen, unsigned char *_out, unsigned _outlen, unsigned bsize, int id, int lev) { 
+int bedecomp(unsigned char *_in, int _inlen, unsigned char *_out, unsigned _outlen, unsigned bsize, int id, int lev, char *prm) { 
   unsigned char *ip;
+  struct codprm cp; codprmini(&cp, id, lev, prm);
   TMDEF; 
   TMBEG('D',tm_repd,tm_Repd);     mempeakinit();
   unsigned char *out,*op;
@@ -1058,7 +1796,7 @@ int bedecomp(unsigned char *_in, int _inlen, unsigned char *_out, unsigned _outl
       int l, iplen = bs==2?ctou16(ip):ctou32(ip); ip += bs;
       if(mcpy && iplen==oplen) 
         memcpy(op, ip, oplen); 
-	  else l = coddecomp(ip, iplen, op, oplen, id, lev);
+	  else { l = cp.decomp(ip, iplen, op, oplen, &cp);              MEMPROF_CALL(oplen); }
       ip += iplen; op += oplen;
     }
   }
@@ -1066,6 +1804,135 @@ int bedecomp(unsigned char *_in, int _inlen, unsigned char *_out, unsigned _outl
   return ip - _in;
 }
 
+// allocation profile (-A): one untimed pass outside the timed repetitions, the hooks call tmtime/backtrace per allocation
+static void memprofrun(int phase, unsigned char *in, unsigned inlen, unsigned char *out, unsigned outlen, unsigned bsize, struct plug *plug) {
+  unsigned repc = tm_repc, Repc = tm_Repc, repd = tm_repd, Repd = tm_Repd;
+  tm_repc = tm_Repc = tm_repd = tm_Repd = 1; tm_prt = 0;
+  memprofbeg(phase);
+  if(phase) bedecomp(in, inlen, out, outlen, bsize, plug->id, plug->lev, plug->prm);
+  else      becomp(  in, inlen, out, outlen, bsize, plug->id, plug->lev, plug->prm);
+  memprofend();
+  tm_repc = repc; tm_Repc = Repc; tm_repd = repd; tm_Repd = Repd; tm_prt = 1;
+}
+
+//----------------------------------- Parallel decompression of independent blocks ------------------------------------------------
+static unsigned parthr[16], parnt;                           // thread counts to benchmark
+
+static void parini(char *s) {                               // "T[,T..]" 0: 1,2,4,.. up to the number of cpus
+  char *q;
+  for(q = s; q && parnt < 16; q = strchr(q, ',')?strchr(q, ',')+1:NULL) 
+    parthr[parnt++] = atoi(q);
+  if(parnt == 1 && !parthr[0]) {
+    unsigned t, nc = 
+      #ifndef _WIN32
+    sysconf(_SC_NPROCESSORS_ONLN);
+      #else
+    1;
+      #endif
+    for(parnt = 0, t = 1; t <= nc && parnt < 16; t *= 2) parthr[parnt++] = t;
+    if(parthr[parnt-1] != nc && parnt < 16) parthr[parnt++] = nc;
+  }
+}
+
+struct pblk { unsigned char *ip, *op; unsigned iplen, oplen; };
+
+// block index: header scan of the becomp output, same layout as in bedecomp. -m: the segment lengths are stored in the output
+static unsigned pbscan(unsigned char *_in, unsigned char *_out, unsigned _outlen, unsigned bsize, struct pblk *bx) {
+  unsigned char *ip = _in, *out = _out, *op; unsigned n = 0;
+  while(out < _out+_outlen) {
+    unsigned outlen;
+    if(mode) { outlen = ctou32(ip); ip += 4; 
+      ctou32(out) = outlen; out += 4;
+      if(out+outlen > _out+_outlen) 
+        outlen = (_out+_outlen)-out; 
+    } else outlen = _outlen;
+    for(op = out, out += outlen; op < out; n++) { 
+      unsigned oplen = min((unsigned)(out - op), bsize), bs = oplen < (1<<16)?2:4;
+      bx[n].iplen = bs==2?ctou16(ip):ctou32(ip); ip += bs;
+      bx[n].ip = ip; bx[n].op = op; bx[n].oplen = oplen;
+      ip += bx[n].iplen; op += oplen;
+    }
+  }
+  return n;
+}
+
+  #ifndef _WIN32
+#include <pthread.h>
+
+static struct ppool { 
+  pthread_mutex_t mu; pthread_cond_t go, done; pthread_t th[256]; 
+  unsigned nt, gen, busy, quit, next, nb; struct pblk *bx; struct codprm *cp; 
+} pp = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static void pprun(void) {                                   // decode the next free blocks into their final offsets
+  unsigned i;
+  while((i = __sync_fetch_and_add(&pp.next, 1)) < pp.nb) { 
+    struct pblk *b = &pp.bx[i];
+    if(mcpy && b->iplen == b->oplen) memcpy(b->op, b->ip, b->oplen); 
+    else pp.cp->decomp(b->ip, b->iplen, b->op, b->oplen, pp.cp);
+  }
+}
+
+static void *ppworker(void *a) {
+  unsigned gen = 0;
+  for(;;) {
+    pthread_mutex_lock(&pp.mu);
+    while(pp.gen == gen && !pp.quit) pthread_cond_wait(&pp.go, &pp.mu);
+    if(pp.quit) { pthread_mutex_unlock(&pp.mu); return NULL; }
+    gen = pp.gen;
+    pthread_mutex_unlock(&pp.mu);
+    pprun();
+    pthread_mutex_lock(&pp.mu);
+    if(!--pp.busy) pthread_cond_signal(&pp.done);
+    pthread_mutex_unlock(&pp.mu);
+  }
+}
+
+static void pppass(void) {                                  // one decompression pass: the calling thread + nt-1 workers
+  pthread_mutex_lock(&pp.mu);
+  pp.next = 0; pp.busy = pp.nt-1; pp.gen++;
+  pthread_cond_broadcast(&pp.go);
+  pthread_mutex_unlock(&pp.mu);
+  pprun();
+  pthread_mutex_lock(&pp.mu);
+  while(pp.busy) pthread_cond_wait(&pp.done, &pp.mu);
+  pthread_mutex_unlock(&pp.mu);
+}
+
+// decompression speed of the blocks in 'out' (becomp output) with 1..n threads. codecs with shared decoder state are refused (codreent)
+static void pardecomp(struct plug *plug, unsigned char *in, unsigned inlen, unsigned char *out, unsigned char *cpy, unsigned bsize, int nb, unsigned long long *hv) {
+  unsigned n = blkcnt(in, inlen, bsize), i, t; struct codprm cp; double t1 = 0; char name[65];
+  struct pblk *bx = (struct pblk *)malloc((n?n:1)*sizeof(bx[0]));
+  if(!bx) die("malloc error\n");
+  if(plug->lev >= 0) sprintf(name, "%s %d%s", plug->s, plug->lev, plug->prm); else sprintf(name, "%s%s", plug->s, plug->prm);
+  printf("\nparallel decompression %s: %u blocks\n", name, n);
+  if(!codreent(plug->id)) { printf(" not supported: shared decoder state (pipeline or custom allocator -a)\n"); free(bx); return; }
+  codprmini(&cp, plug->id, plug->lev, plug->prm);
+  printf(" threads     D MB/s  speedup\n");
+  for(i = 0; i < parnt; i++) {
+    if(!(t = parthr[i])) continue;
+    if(t > 256) t = 256;
+    pp.nt = t; pp.quit = 0; pp.cp = &cp; pp.bx = bx; pp.nb = 0; pp.gen = 0;
+    for(t = 0; t < pp.nt-1; t++) 
+      if(pthread_create(&pp.th[t], NULL, ppworker, NULL)) die("pthread_create error\n");
+    memrcpy(cpy, in, inlen);
+    TMDEF;
+    TMBEG('P', tm_repd, tm_Repd);
+    pp.nb = pbscan(out, cpy, inlen, bsize, bx);
+    pppass();
+    TMEND;
+    pthread_mutex_lock(&pp.mu); pp.quit = 1; pthread_cond_broadcast(&pp.go); pthread_mutex_unlock(&pp.mu);
+    for(t = 0; t < pp.nt-1; t++) pthread_join(pp.th[t], NULL);
+    double td = (double)tm_tm/((double)tm_rm*nb); 
+    if(!t1) t1 = td;                                        // speedup vs. the first thread count
+    printf("%8u %10.2f %8.2f%s\n", pp.nt, TMBS(inlen/nb, td), td > 0?t1/td:0.0, (hv?memhashdiff(cpy, inlen, hv):memdiff(in, cpy, inlen)) < inlen?" (error)":"");
+  }
+  free(bx);
+}
+  #else
+static void pardecomp(struct plug *plug, unsigned char *in, unsigned inlen, unsigned char *out, unsigned char *cpy, unsigned bsize, int nb, unsigned long long *hv) { die("--threads not supported\n"); }
+  #endif
+
   #ifdef LZTURBO
 #include "../bebench.h"
   #else
@@ -1118,7 +1985,12 @@ unsigned long long plugfile(struct plug *plug, char *finame, unsigned long long
   int    pagesize = getpagesize();
   size_t insizem  = (fuzz&3)?SIZE_ROUNDUP(insize, pagesize):(insize+INOVD);
 
-  outsize = insize*fac + 10*Mb; 
+  size_t bound = mode?0:codbound(min(plug->blksize, insize), plug->id);
+  if(bound) {                                               // codec bound + block headers
+    size_t nb = (insize + plug->blksize-1) / plug->blksize;
+    outsize = nb*(bound+4) + INOVD;
+  } else
+    outsize = insize*fac + 10*Mb; 
   unsigned char *_in = NULL;
   if(insizem && !(_in = _valloc(insizem,1)))
     die("malloc error in size=%u\n", insizem);
@@ -1127,15 +1999,21 @@ unsigned long long plugfile(struct plug *plug, char *finame, unsigned long long
   if(!out)
     die("malloc error out size=%u\n", outsize);
 
-  if((cmp || tid) && insizem && !(_cpy = _valloc(insizem,3)))
+  if(((cmp && !vhash) || tid || ovhd) && insizem && !(_cpy = _valloc(insizem,3)))
     die("malloc error cpy size=%u\n", insizem);
+  unsigned long long *hv = NULL;                            // hash verify: decompress into the input buffer
+  if(vhash && !(hv = (unsigned long long *)malloc((insizem/HBLK+1)*sizeof(hv[0]))))
+    die("malloc error\n");
  
   codini(insize, plug->id);	
+  char *q = strchr(plug->prm, 'a'); codalloc(!codballoc(plug->id)?0:(q?atoi(q+1):balloc));
+  memprofini();
   int       inlen;																	
   long long totinlen = 0;
   double    ptc = DBL_MAX, ptd = DBL_MAX;
   bsize     = plug->blksize;
-  plug->len = plug->tc = plug->td = 0; 											blknum = 0;	
+  plug->len = plug->tc = plug->td = 0; 											blknum = 0;
+  plug->rssc = plug->rssd = plug->pfc = plug->pfd = plug->pfmc = plug->pfmd = 0;	
 
   while((inlen = fread(_in, 1, insize, fi)) > 0) {    
     unsigned char *in = _in; 
@@ -1155,23 +2033,44 @@ unsigned long long plugfile(struct plug *plug, char *finame, unsigned long long
         memcpy(p, in, l);
       }
     }
+    if(hv) memhashv(in, l*nb, hv);
+    if(ovhd && plug->id != P_NULL && (ovhbsize != bsize || ovhlen != l*nb)) { // calibrate: same blocks through the null codec
+      unsigned nblk = blkcnt(in, l*nb, bsize), ol;
+      ovhbsize = bsize; ovhlen = l*nb;
+      ol = becomp(in, l*nb, out, outsize, bsize, P_NULL, 0, "");  ovhtc = (double)tm_tm/((double)tm_rm*nb); 
+      bedecomp(out, ol, _cpy, l*nb, bsize, P_NULL, 0, "");             ovhtd = (double)tm_tm/((double)tm_rm*nb);    
+      if(verbose) { printf("harness overhead: C %.1f ns D %.1f ns per call (%u calls)\n", ovhtc*1000.0*nb/nblk, ovhtd*1000.0*nb/nblk, nblk); fflush(stdout); }
+    }
+    long long rss0 = rssinit(), pf0, pfm0, pf1, pfm1; pfget(&pf0, &pfm0);
     size_t peak = mempeakinit();
 	outlen = becomp(in, l*nb, out, outsize, bsize, plug->id, plug->lev, plug->prm)/nb;
-	plug->len += outlen; plug->tc += (tc += (double)tm_tm/((double)tm_rm*nb)); 
+	plug->len += outlen; plug->tc += (tc += OVHCOR((double)tm_tm/((double)tm_rm*nb), ovhtc));
 	plug->memc = mempeak() - peak;
+    pfget(&pf1, &pfm1); plug->pfc += pf1 - pf0; plug->pfmc += pfm1 - pfm0;
+    if((rss0 = rsspeak() - rss0) > plug->rssc) plug->rssc = rss0;
+    if(memprof) 
+      memprofrun(0, in, l*nb, out, outsize, bsize, plug);
     if(tm_Repc > 1) 
       TMSLEEP;
 																								if(verbose && inlen == filen) { double ratio = (double)outlen*100.0/inlen; printf("%12u   %5.1f   %8.2f   ", outlen, ratio, TMBS(inlen,tc)); fflush(stdout); }
     if(cmp) {
-      unsigned char *cpy = _cpy; 
-      if(fuzz & 2) cpy = (_cpy+insizem) - l;
-	  if(_cpy != _in) memrcpy(cpy, in, l);
+      unsigned char *cpy = hv?in:_cpy; 
+      if((fuzz & 2) && !hv) cpy = (_cpy+insizem) - l;
+	  if(hv || _cpy != _in) memrcpy(cpy, in, hv?l*nb:l);
+      rss0 = rssinit(); pfget(&pf0, &pfm0);
       peak = mempeakinit();
-	  unsigned cpylen = bedecomp(out, outlen, cpy, l*nb, bsize, plug->id,plug->lev)/nb; 
-	  td = (double)tm_tm/((double)tm_rm*nb);		
-      plug->memd = mempeak() - peak;                                                             if(verbose && inlen == filen) { printf("%8.2f   %-16s%s\n", TMBS(inlen,td), name, finame); }
-      int e = memcheck(in, l, cpy, fuzz?3:cmp);  
+	  unsigned cpylen = bedecomp(out, outlen, cpy, l*nb, bsize, plug->id,plug->lev, plug->prm)/nb;
+	  td = OVHCOR((double)tm_tm/((double)tm_rm*nb), ovhtd);
+      plug->memd = mempeak() - peak;
+      pfget(&pf1, &pfm1); plug->pfd += pf1 - pf0; plug->pfmd += pfm1 - pfm0;
+      if((rss0 = rsspeak() - rss0) > plug->rssd) plug->rssd = rss0;
+      if(memprof) 
+        memprofrun(1, out, outlen, cpy, l*nb, bsize, plug);
+      if(verbose && inlen == filen) { printf("%8.2f   %-16s%s\n", TMBS(inlen,td), name, finame); }
+      int e = plug->id == P_NULL?0:(hv?memhcheck(cpy, l*nb, hv, fuzz?3:cmp):memcheck(in, l, cpy, fuzz?3:cmp));  
       plug->err = plug->err?plug->err:e;
+      if(parnt && plug->id != P_NULL) 
+        pardecomp(plug, in, l*nb, out, cpy, bsize, nb, hv);
       BEPOST;																	
  	  plug->td += td; 
 	} else 																						 if(verbose && inlen == filen) { printf("%8.2f   %-16s%s\n", 0.0, name, finame); }
@@ -1182,41 +2081,839 @@ unsigned long long plugfile(struct plug *plug, char *finame, unsigned long long
   _vfree(_in, insizem);
   if(_cpy && _cpy != _in) 
     _vfree(_cpy, insizem); 
+  free(hv);
   codexit(plug->id);
   fclose(fi); 
+  memprofprt(name, 0);
+  memprofprt(name, 1);
+  if(verbose) codpipeprt(plug->id, stdout);
   if(verbose && filen > insize) 
     plugprt(plug, totinlen, finame, FMT_TEXT, &ptc, &ptd,stdout);
   return totinlen;
 }
 
+//----------------------------------- Corpus: directories, file types, per file results --------------------------------------
+static char **flist;                                        // input files after directory expansion
+static int    fnum, flmax, fgrp, fpre;
+static char  *fglob;                                        // include/exclude globs ex. "*.json,*.log,!*.tmp"
+
+static int wmatch(const char *p, const char *s) {           // glob with '*' and '?'
+  for(; *p; p++, s++) {
+    if(*p == '*') { 
+      while(*p == '*') p++; 
+      if(!*p) return 1;
+      for(; *s; s++) if(wmatch(p, s)) return 1;
+      return 0;
+    }
+    if(!*s || (*p != '?' && *p != *s)) return 0;
+  }
+  return !*s;
+}
+
+static int fglobok(const char *name) {
+  char s[1024], *p; int inc = 0, ninc = 0;
+  if(!fglob) return 1;
+  strncpy(s, fglob, sizeof(s)-1); s[sizeof(s)-1] = 0;
+  for(p = strtok(s, ","); p; p = strtok(NULL, ",")) 
+    if(*p == '!') { if(wmatch(p+1, name)) return 0; }
+    else { ninc++; if(wmatch(p, name)) inc++; }
+  return !ninc || inc;
+}
+
+static void fladd(const char *name) {
+  if(fnum >= flmax && !(flist = (char **)realloc(flist, (flmax = flmax?flmax*2:1024)*sizeof(flist[0])))) die("malloc error\n");
+  flist[fnum++] = strdup(name);
+}
+
+static int fcmp(const void *a, const void *b) { return strcmp(*(char **)a, *(char **)b); }
+
+// add files in 'path'. directories: files in the directory + subdirectories if 'recurse' 
+static void fwalk(const char *path, int recurse, int depth) {
+    #ifndef _WIN32
+  struct stat st; DIR *dir; struct dirent *de; int n = fnum;
+  if(stat(path, &st) || !S_ISDIR(st.st_mode)) { if(!depth || fglobok(strrchr(path,'/')?strrchr(path,'/')+1:path)) fladd(path); return; }
+  if((depth && !recurse) || !(dir = opendir(path))) return;
+  while((de = readdir(dir))) {
+    char f[4096];
+    if(de->d_name[0] == '.' && (!de->d_name[1] || (de->d_name[1] == '.' && !de->d_name[2]))) continue;
+    snprintf(f, sizeof(f), "%s/%s", path, de->d_name);
+    if(stat(f, &st)) continue;
+    if(S_ISDIR(st.st_mode)) fwalk(f, recurse, depth+1);
+    else if(S_ISREG(st.st_mode) && fglobok(de->d_name)) fladd(f);
+  }
+  closedir(dir);
+  qsort(flist+n, fnum-n, sizeof(flist[0]), fcmp);
+    #else
+  fladd(path);
+    #endif
+}
+
+  #ifndef _WIN32
+#include <pthread.h>
+static unsigned long long fpremax;
+static void *fprefetch_(void *a) {                          // read the files into the page cache 
+  static char buf_[64][1<<16]; char *buf = buf_[(ptrdiff_t)a]; int i;
+  while((i = __sync_fetch_and_add(&fpre, 1)) < fnum) {
+    int fd = open(flist[i], O_RDONLY); unsigned long long n = 0; ssize_t l;
+    if(fd < 0) continue;
+    while(n < fpremax && (l = read(fd, buf, sizeof(buf_[0]))) > 0) n += l;
+    close(fd);
+  }
+  return NULL;
+}
+  #endif
+
+// parallel file loading before the benchmark (no disk i/o during the timing)
+void fprefetch(unsigned long long filenmax) {
+    #ifndef _WIN32
+  pthread_t th[64]; long i, nt = sysconf(_SC_NPROCESSORS_ONLN); 
+  if(nt > 64) nt = 64; 
+  if(nt > fnum) nt = fnum; 
+  if(nt < 1) return;
+  fpremax = filenmax; fpre = 0;
+  for(i = 0; i < nt; i++) pthread_create(&th[i], NULL, fprefetch_, (void *)i);
+  for(i = 0; i < nt; i++) pthread_join(th[i], NULL);
+    #endif
+}
+
+// content type from the first 4k of the file
+char *ftype(char *finame) {
+  unsigned char b[4096]; int n, i, bin = 0, lines = 0, loglines = 0; 
+  FILE *f = fopen(finame, "rb"); 
+  if(!f) return "?";
+  n = fread(b, 1, sizeof(b), f); fclose(f);
+  if(!n) return "empty";
+  if((n >= 2 && b[0] == 0x1f && b[1] == 0x8b) || (n >= 4 && (!memcmp(b, "PK\3\4", 4) || !memcmp(b, "\xfd" "7zX", 4) || !memcmp(b, "\x28\xb5\x2f\xfd", 4))) || (n >= 3 && !memcmp(b, "BZh", 3))) return "compressed";
+  if(n >= 4 && (!memcmp(b, "\x89PNG", 4) || !memcmp(b, "GIF8", 4) || (b[0] == 0xff && b[1] == 0xd8))) return "image";
+  if(n >= 4 && !memcmp(b, "%PDF", 4)) return "pdf";
+  if(n >= 4 && (!memcmp(b, "\x7f" "ELF", 4) || (b[0] == 'M' && b[1] == 'Z'))) return "executable";
+  for(i = 0; i < n; i++) 
+    if(b[i] < 9 || (b[i] > 13 && b[i] < 32 && b[i] != 27)) bin++;
+  if(bin*100 > n) return "binary";
+  for(i = 0; i < n && isspace(b[i]); i++);
+  if(i < n && (b[i] == '{' || b[i] == '[')) return "json";
+  if(i < n && b[i] == '<') return "xml";
+  for(i = 0; i < n; i++)                                   // log: most lines start with a date/time or '['
+    if(!i || b[i-1] == '\n') { lines++; if(isdigit(b[i]) || b[i] == '[') loglines++; }
+  return loglines*2 > lines && lines > 2?"log":"text";
+}
+
+static char *fgroup(char *finame, char *s) {
+  char *p = strrchr(finame, '/'), *q; 
+  if(fgrp == 2) return ftype(finame);
+  p = p?p+1:finame;
+  if(!(q = strrchr(p, '.')) || q == p) return "(none)";
+  strncpy(s, q+1, 31); s[31] = 0;
+  for(q = s; *q; q++) *q = tolower(*q);
+  return s;
+}
+
+struct fres { long long len; double tc, td; };              // result per file and codec
+
+// per file results 'finame.tbf' and reports per extension/content type
+void plugfiles(struct plug *plug, int k, char **files, int nf, long long *fsize, struct fres *fr, char *finame, int fmt, char *rem) {
+  char s[1024], gs[32], **grp = (char **)calloc(nf, sizeof(char *)); int i, j, c, n;
+  sprintf(s, "%s.tbf", finame);
+  FILE *f = fopen(s, "w");
+  if(f) fprintf(f, "file\ttype\tsize\tcodec\tlevel\tparam\tcsize\tctime\tdtime\n");
+  for(i = 0; i < nf; i++) {
+    grp[i] = strdup(fgroup(files[i], gs));
+    if(f) 
+      for(c = 0; c < k; c++) { struct fres *r = &fr[i*k+c];
+        fprintf(f, "%s\t%s\t%lld\t%s\t%d\t%s\t%lld\t%.6f\t%.6f\n", files[i], grp[i], fsize[i], plug[c].s, plug[c].lev, plug[c].prm[0]?plug[c].prm:"?", r->len, r->tc, r->td);
+      }
+  }
+  if(f) fclose(f);
+  if(!fgrp) { free(grp); return; }
+  for(i = 0; i < nf; i++) {                                 // one report per group
+    long long tot = 0;
+    if(!grp[i]) continue;
+    for(c = 0; c < k; c++) { plugt[c] = plug[c]; plugt[c].len = 0; plugt[c].tc = plugt[c].td = 0; }
+    for(j = i, n = 0; j < nf; j++) 
+      if(grp[j] && !strcmp(grp[j], grp[i])) { 
+        tot += fsize[j]; n++;
+        for(c = 0; c < k; c++) { plugt[c].len += fr[j*k+c].len; plugt[c].tc += fr[j*k+c].tc; plugt[c].td += fr[j*k+c].td; }
+        if(j > i) { free(grp[j]); grp[j] = NULL; }
+      }
+    printf("\n%s: %d file(s)\n", grp[i], n);
+    sprintf(s, "%s.%s", finame, grp[i]);
+    plugprts(plugt, k, s, fmt?-1:0, tot, fmt?fmt:FMT_TEXT, rem);
+    free(grp[i]); grp[i] = NULL;
+  }
+  free(grp);
+}
+
+//----------------------------------- Data characterization ---------------------------------------------------------------------
+static int dchar;
+
+static double entropy(unsigned *c, int n, unsigned long long *tot) { // entropy in bits of the counts c[0..n-1]
+  unsigned long long t = 0; double h = 0; int i;
+  for(i = 0; i < n; i++) t += c[i];
+  for(i = 0; i < n; i++) if(c[i]) h -= (double)c[i] * log2((double)c[i]/t);
+  *tot = t;
+  return h;
+}
+
+#define DC_HBITS 20
+#define DC_MINLEN 4
+// order-0/1/2 entropy, runs, LZ77 matches with a hash match finder, record stride
+void datachar(char *finame, unsigned long long filenmax) {
+  FILE *fi = fopen(finame, "rb"); unsigned char *in; unsigned long long n, i, t; unsigned *c; int j;
+  if(!fi) { perror(finame); return; }
+  fseeko(fi, 0, SEEK_END); n = ftello(fi); fseeko(fi, 0, SEEK_SET); if(n > filenmax) n = filenmax;
+  if(!n || !(in = (unsigned char *)malloc(n))) { fclose(fi); return; }
+  n = fread(in, 1, n, fi); fclose(fi);
+  if(!(c = (unsigned *)calloc(1<<24, sizeof(c[0])))) { free(in); return; }
+  printf("%s: %llu bytes\n", finame, n);
+                                                            //---- entropy order 0,1,2 (bits/byte + size bound)
+  double h0, h1 = 0, h2 = 0; 
+  for(i = 0; i < n; i++) c[in[i]]++;
+  h0 = entropy(c, 256, &t);
+  memset(c, 0, (1<<16)*sizeof(c[0]));
+  for(i = 1; i < n; i++) c[in[i-1]<<8 | in[i]]++;
+  for(j = 0; j < 256; j++) h1 += entropy(&c[j<<8], 256, &t);
+  memset(c, 0, (1<<24)*sizeof(c[0]));
+  for(i = 2; i < n; i++) c[(unsigned)in[i-2]<<16 | in[i-1]<<8 | in[i]]++;
+  for(j = 0; j < 1<<16; j++) h2 += entropy(&c[j<<8], 256, &t);
+  printf("  entropy   o0 %.4f  o1 %.4f  o2 %.4f bits/byte  bound o0 %llu (%.2f%%) o1 %llu (%.2f%%) o2 %llu (%.2f%%)\n", 
+    h0/n, h1/n, h2/n, (unsigned long long)(h0/8), h0*100.0/(8.0*n), (unsigned long long)(h1/8), h1*100.0/(8.0*n), (unsigned long long)(h2/8), h2*100.0/(8.0*n));
+                                                            //---- runs of equal bytes
+  unsigned long long runs = 0, rbytes = 0, rmax = 0, r;
+  for(i = 0; i < n; i += r) {
+    for(r = 1; i+r < n && in[i+r] == in[i]; r++);
+    if(r >= 2) { runs++; if(r >= DC_MINLEN) rbytes += r; if(r > rmax) rmax = r; }
+  }
+  printf("  runs      %llu runs >= 2  max %llu  bytes in runs >= %d: %.2f%%\n", runs, rmax, DC_MINLEN, rbytes*100.0/n);
+                                                            //---- LZ77 greedy hash match finder: coverage by offset
+  static const unsigned long long olim[] = { 64, 1<<10, 1<<16, 1<<20, ~0ull }; 
+  static const char *oname[] = { "<=64", "<=1K", "<=64K", "<=1M", ">1M" };
+  unsigned long long cov[5] = {0}, nm = 0, lsum = 0;
+  unsigned *ht = c; memset(ht, 0, (1<<DC_HBITS)*sizeof(ht[0]));  // position+1 
+  for(i = 0; i+DC_MINLEN <= n; ) {
+    unsigned h = (ctou32(in+i) * 2654435761u) >> (32-DC_HBITS), p = ht[h]; unsigned long long l = 0;
+    ht[h] = i+1;
+    if(p-- && i-p <= 0xffffffffu && ctou32(in+p) == ctou32(in+i)) 
+      for(l = DC_MINLEN; i+l < n && in[p+l] == in[i+l]; l++);
+    if(l >= DC_MINLEN) { 
+      for(j = 0; i-p > olim[j]; j++); 
+      cov[j] += l; nm++; lsum += l; i += l; 
+    } else i++;
+  }
+  printf("  matches   %llu avg.len %.1f  coverage %.2f%%:", nm, nm?(double)lsum/nm:0.0, lsum*100.0/n);
+  for(j = 0; j < 5; j++) printf(" %s %.2f%%", oname[j], cov[j]*100.0/n);
+  printf("\n");
+                                                            //---- record stride: most frequent distance of equal bytes 
+  unsigned long long eq[257] = {0}, m = min(n, 1ull<<20), rnd = 0; int s, best = 0;  // sample 1MB
+  for(s = 1; s <= 256; s++) 
+    for(i = s; i < m; i++) eq[s] += in[i] == in[i-s];
+  for(s = 2; s <= 256; s++) if(eq[s] > eq[best]) best = s; // smallest stride near the maximum (not the multiples)
+  for(s = 2; s < best; s++) if(eq[s] >= eq[best]*0.95 && best % s == 0) { best = s; break; }
+  memset(c, 0, 256*sizeof(c[0])); for(i = 0; i < m; i++) c[in[i]]++;   // probability of equal bytes in random order
+  for(j = 0; j < 256; j++) rnd += (unsigned long long)c[j]*c[j];
+  double pr = m?(double)rnd/((double)m*m):0, pb = m > best?(double)eq[best]/(m-best):0, p1 = m > 1?(double)eq[1]/(m-1):0;
+  if(best && pb > 2*pr && pb > 1.2*p1) printf("  stride    %d (%.2f%% equal bytes, random %.2f%%, stride 1 %.2f%%)\n", best, pb*100, pr*100, p1*100);
+  else                                 printf("  stride    none\n");
+  free(c); free(in);
+}
+
+//----------------------------------- Recommendation: best ratio under constraints ------------------------------------------------
+static char *reco;
+
+struct rcand { struct plug p; double tc, td; long long len, mem; }; 
+
+static int rcandcmp(const void *a, const void *b) { 
+  const struct rcand *e1 = (const struct rcand *)a, *e2 = (const struct rcand *)b;
+  return e1->len < e2->len?-1:(e1->len > e2->len?1:(e1->tc < e2->tc?-1:(e1->tc > e2->tc?1:0))); 
+}
+
+static void recorun(struct rcand *r, char **fin, int fnum, unsigned long long filenmax, unsigned reps, tm_t tx) { // one measurement of r over all files
+  unsigned repc = tm_Repc, repd = tm_Repd; tm_t t = tm_tx; int v = verbose, i;
+  tm_Repc = tm_Repd = reps; tm_tx = tx; verbose = 0; tm_prt = 0; 
+  r->len = r->mem = 0; r->tc = r->td = 0;
+  for(i = 0; i < fnum; i++) {
+    plugfile(&r->p, fin[i], filenmax, r->p.blksize, plugr, tid, 0);
+    r->len += r->p.len; r->tc += r->p.tc; r->td += r->p.td;
+    if(r->p.memc > r->mem) r->mem = r->p.memc;
+    if(r->p.memd > r->mem) r->mem = r->p.memd;
+  }
+  tm_Repc = repc; tm_Repd = repd; tm_tx = t; verbose = v; tm_prt = 1;
+}
+
+struct rcons { double cmin, dmin; long long mmax; unsigned bs[16]; int nbs, nr; };
+
+// constraints "c#,d#,m#,b#/#,n#" ex. "d>=1500,c>=200,m<=64M": c/d min. de/compression MB/s, m max. memory, b block sizes (0=file), n shortlist
+static void rconsget(char *q, struct rcons *rs) {
+  while(*q) {
+    char c = *q++; 
+    while(*q && !isalnum(*q)) q++;
+    switch(c) {
+      case 'c': rs->cmin = strtod(q, NULL); break;
+      case 'd': rs->dmin = strtod(q, NULL); break;
+      case 'm': rs->mmax = argtol(q);       break;
+      case 'n': rs->nr   = atoi(q);         break;
+      case 'b': for(rs->nbs = 0; rs->nbs < 16; ) { rs->bs[rs->nbs++] = atoi(q)?argtoi(q):0; while(isalnum(*q)) q++; if(*q != '/') break; q++; } break;
+    }
+    while(*q && *q != ',') q++; 
+    if(*q) q++;
+  }
+}
+
+void recommend(char *cons, struct plug *plug, int k, char **fin, int fnum, unsigned long long filenmax) {
+  struct rcons rs = { 0, 0, 0, {64*Kb, Mb, 0}, 3, 5 }; long long tot = 0; int n = 0, m, i, j, r;
+  rconsget(cons, &rs);
+  double cmin = rs.cmin, dmin = rs.dmin; long long mmax = rs.mmax; unsigned *bs = rs.bs; int nbs = rs.nbs, nr = rs.nr;
+  if(nr < 1) nr = 1;
+  for(i = 0; i < fnum; i++) { FILE *f = fopen(fin[i], "rb"); if(f) { fseeko(f, 0, SEEK_END); tot += min(ftello(f), filenmax); fclose(f); } }
+  if(!tot) die("recommendation: no input\n");
+
+  struct plugs *gs; int ng = 0;                                 // candidates: -e codecs or all codecs/levels x block sizes 
+  for(gs = plugs; gs->id >= 0; gs++) ng += gs->lev?strlen(gs->lev)+1:1;
+  struct rcand *rc = (struct rcand *)calloc((size_t)(k+ng)*nbs, sizeof(rc[0])); 
+  if(!rc) die("malloc error\n");
+  if(k) {
+    for(i = 0; i < k; i++) 
+      for(j = 0; j < nbs; j++) 
+        if(bs[j] < tot) { rc[n].p = plug[i]; rc[n++].p.blksize = bs[j]?bs[j]:Gb; }
+  } else 
+    for(gs = plugs; gs->id >= 0; gs++) {
+      if(!gs->codec || !gs->lev || gs->id == P_NULL) continue;
+      char *l = gs->lev; 
+      do {
+        int lev = -1; 
+        if(*l && *l != '/') { lev = strtol(l, &l, 10); while(*l == ',') l++; }
+        for(j = 0; j < nbs; j++) { 
+          if(bs[j] >= tot || (j && (gs->flag & (E_ANS|E_HUF)))) continue;     // block >= input is the same as 'file'
+          struct plug *p = &rc[n++].p; 
+          p->id = gs->id; p->s = gs->s; p->lev = lev; p->prm[0] = 0; 
+          p->blksize = gs->flag & E_ANS?seg_ans:(gs->flag & E_HUF?seg_huf:(bs[j]?bs[j]:Gb));
+        }
+      } while(*l && *l != '/' && isdigit(*l));
+    }
+
+  static const struct { unsigned reps; tm_t tx; double tol; } rd[] = { { 1, TM_T/50, 0.5 }, { 2, TM_T/20, 0.8 }, { 3, TM_T/4, 1.0 } }; // progressive refinement
+  printf("Recommendation: %d candidates, %lld bytes, compress >= %.0f MB/s, decompress >= %.0f MB/s, memory <= %lld\n", n, tot, cmin, dmin, mmax); 
+  for(r = 0; r < 3; r++) {
+    for(m = i = 0; i < n; i++) {
+      struct rcand *c = &rc[i]; 
+      recorun(c, fin, fnum, filenmax, rd[r].reps, rd[r].tx);
+      if(c->p.err || TMBS(tot, c->tc) < cmin*rd[r].tol || TMBS(tot, c->td) < dmin*rd[r].tol || (mmax && c->mem > mmax)) continue;
+      rc[m++] = *c;
+    }
+    qsort(rc, m, sizeof(rc[0]), rcandcmp);
+    printf("round %d: %d -> %d\n", r+1, n, m); fflush(stdout);
+    n = r?min(m, nr*(3-r)):min(m, nr*8);                          // keep the best ratios for the next round
+  }
+  if(!n) { printf("no codec satisfies the constraints\n"); free(rc); return; }
+  printf("  #  %-24s %8s %12s %7s %9s %9s %9s\n", "Name", "Block", "C Size", "ratio%", "C MB/s", "D MB/s", "Mem");
+  for(i = 0; i < n; i++) {
+    struct rcand *c = &rc[i]; char name[65], b[16];
+    if(c->p.lev >= 0) sprintf(name, "%s %d%s", c->p.s, c->p.lev, c->p.prm); else sprintf(name, "%s%s", c->p.s, c->p.prm);
+    if(c->p.blksize >= tot) strcpy(b, "file"); else if(c->p.blksize % Mb == 0) sprintf(b, "%um", c->p.blksize/Mb); else if(c->p.blksize % Kb == 0) sprintf(b, "%uk", c->p.blksize/Kb); else sprintf(b, "%u", c->p.blksize);
+    printf("%3d  %-24s %8s %12lld %7.2f %9.2f %9.2f %9lld\n", i+1, name, b, c->len, (double)c->len*100.0/tot, TMBS(tot, c->tc), TMBS(tot, c->td), c->mem);
+  }
+  free(rc);
+}
+
+//----------------------------------- Oracle: best codec per block ----------------------------------------------------------------
+static char *orac;
+
+struct oblk { unsigned len; float tc, td; };                // per block and codec: compressed length (0=error), time in us
+
+// compress every block with each codec, select per block the smallest output meeting the speed constraints "c#,d#"
+void oracle(char *cons, struct plug *plug, int k, char **fin, int fnum, unsigned long long filenmax, unsigned bsize) {
+  struct rcons rs = { 0 }; int i, f, md = mode; unsigned repc = tm_Repc, repd = tm_Repd; tm_t tx = tm_tx; 
+  long long tot = 0, nblk = 0, olen = 0, nfb = 0; double otc = 0, otd = 0;
+  if(k > 52) k = 52;                                        // map letters a..z,A..Z
+  rconsget(cons, &rs);
+  long long *plen = (long long *)calloc(k, sizeof(plen[0])), *win = (long long *)calloc(k, sizeof(win[0]));
+  double    *ptc  = (double    *)calloc(k, sizeof(ptc[0])),  *ptd = (double    *)calloc(k, sizeof(ptd[0])); 
+  if(!plen || !win || !ptc || !ptd) die("malloc error\n");
+  mode = 0; tm_Repc = tm_Repd = 1; tm_tx = TM_T/100; tm_prt = 0;
+
+  for(f = 0; f < fnum; f++) {
+    FILE *fi = fopen(fin[f], "rb"); if(!fi) { perror(fin[f]); continue; }
+    fseeko(fi, 0, SEEK_END); unsigned long long n = ftello(fi); fseeko(fi, 0, SEEK_SET); if(n > filenmax) n = filenmax;
+    size_t nb = (n + bsize-1)/bsize, b, outsize = bsize*fac + 10*Mb;
+    unsigned char *in = (unsigned char *)malloc(n+INOVD), *out = (unsigned char *)malloc(outsize), *cpy = (unsigned char *)malloc(bsize+INOVD);
+    struct oblk *ob = (struct oblk *)calloc(nb*k+1, sizeof(ob[0]));
+    char *map = (char *)malloc(nb+1);
+    if(!in || !out || !cpy || !ob || !map) die("malloc error\n");
+    n = fread(in, 1, n, fi); fclose(fi);
+    nb = (n + bsize-1)/bsize;
+
+    for(i = 0; i < k; i++) {
+      struct plug *p = &plug[i];
+      codini(n, p->id);
+      for(b = 0; b < nb; b++) {
+        struct oblk *o = &ob[b*k+i]; unsigned l = min(bsize, n - b*bsize), ol;
+        if(!(ol = becomp(in+b*bsize, l, out, outsize, bsize, p->id, p->lev, p->prm))) continue;
+        o->tc = (double)tm_tm/tm_rm;
+        bedecomp(out, ol, cpy, l, bsize, p->id, p->lev, p->prm);
+        o->td = (double)tm_tm/tm_rm;
+        if(!memcmp(in+b*bsize, cpy, l)) o->len = ol; 
+      }
+      codexit(p->id);
+    }
+
+    for(b = 0; b < nb; b++) {                               // oracle: smallest block within the constraints, else fastest decompression 
+      unsigned l = min(bsize, n - b*bsize); int w = -1, wf = -1;
+      for(i = 0; i < k; i++) {
+        struct oblk *o = &ob[b*k+i];
+        if(!o->len) { plen[i] = -1; continue; }
+        if(plen[i] >= 0) { plen[i] += o->len; ptc[i] += o->tc; ptd[i] += o->td; }
+        if(wf < 0 || o->td < ob[b*k+wf].td) wf = i;
+        if(TMBS(l, o->tc) >= rs.cmin && TMBS(l, o->td) >= rs.dmin && (w < 0 || o->len < ob[b*k+w].len || (o->len == ob[b*k+w].len && o->td < ob[b*k+w].td))) w = i;
+      }
+      if(w < 0) { w = wf; nfb++; }
+      if(w < 0) { map[b] = '?'; continue; }
+      map[b] = w < 26?'a'+w:'A'+w-26; win[w]++;
+      olen += ob[b*k+w].len + 1; otc += ob[b*k+w].tc; otd += ob[b*k+w].td;
+      if(verbose > 1) {
+        printf("%8zu %12llu %c", b, (unsigned long long)b*bsize, map[b]);
+        for(i = 0; i < k; i++) printf(" %10u", ob[b*k+i].len); 
+        printf("\n");
+      }
+    }
+    map[nb] = 0;
+    printf("%s:\n", fin[f]);
+    for(b = 0; b < nb; b += 64) printf("%12llu %.64s\n", (unsigned long long)b*bsize, map+b);
+    tot += n; nblk += nb;
+    free(map); free(ob); free(cpy); free(out); free(in);
+  }
+  mode = md; tm_Repc = repc; tm_Repd = repd; tm_tx = tx; tm_prt = 1;
+  if(!tot) die("oracle: no input\n");
+
+  int best = -1;                                            // best single codec within the constraints
+  for(i = 0; i < k; i++) 
+    if(plen[i] > 0 && TMBS(tot, ptc[i]) >= rs.cmin && TMBS(tot, ptd[i]) >= rs.dmin && (best < 0 || plen[i] < plen[best])) best = i;
+  printf("\nOracle: %lld blocks of %u bytes, compress >= %.0f MB/s, decompress >= %.0f MB/s per block\n", nblk, bsize, rs.cmin, rs.dmin);
+  printf("      C Size  ratio%%     C MB/s     D MB/s    Blocks   Name\n");
+  for(i = 0; i < k; i++) {
+    char name[65]; struct plug *p = &plug[i];
+    if(p->lev >= 0) sprintf(name, "%s %d%s", p->s, p->lev, p->prm); else sprintf(name, "%s%s", p->s, p->prm);
+    if(plen[i] < 0) printf("%12s %7s %10s %10s %9lld   %c=%s (error)\n", "", "", "", "", win[i], i < 26?'a'+i:'A'+i-26, name);
+    else printf("%12lld %7.2f %10.2f %10.2f %9lld   %c=%s%s\n", plen[i], (double)plen[i]*100.0/tot, TMBS(tot, ptc[i]), TMBS(tot, ptd[i]), win[i], i < 26?'a'+i:'A'+i-26, name, i == best?" (best single)":"");
+  }
+  printf("%12lld %7.2f %10.2f %10.2f %9lld   oracle (+1 byte codec id per block)\n", olen, (double)olen*100.0/tot, TMBS(tot, otc), TMBS(tot, otd), nblk);
+  if(nfb) printf("%lld blocks without a codec within the constraints: fastest decompression used\n", nfb);
+  if(best >= 0) printf("oracle gain vs. best single codec: %.2f%% smaller\n", (double)(plen[best] - olen)*100.0/plen[best]);
+  else          printf("no single codec within the constraints\n");
+  free(plen); free(win); free(ptc); free(ptd);
+}
+
+//----------------------------------- Storage read path: scratch file, O_DIRECT or page cache, async reads ------------------------
+static char *iopath;
+  #ifndef _WIN32
+#include <aio.h>
+#define IOALIGN 4096
+
+static double cputime(void) { 
+  struct rusage ru; getrusage(RUSAGE_SELF, &ru); 
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)*TM_T + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec; 
+}
+
+struct ioblk { long long ofs; unsigned clen, len, plen; };  // offset in the scratch file, compressed/raw/padded length
+
+// write the compressed blocks of each codec to a scratch file and read them back with 'qd' reads in flight, decompressing as they arrive
+// arg = "path[,q#][,c]" path: scratch file or directory, q#: queue depth (default 4), c: page cache (dropped) instead of O_DIRECT
+void iobench(char *arg, struct plug *plug, int k, char **fin, int fnum, unsigned long long filenmax, unsigned bsize) {
+  char *q, fn[1024]; int qd = 4, pcache = 0, i, f; struct stat st; long long n = 0;
+  if((q = strchr(arg, ','))) *q++ = 0;
+  for(; q && *q; ) { 
+    if(*q == 'q') qd = atoi(q+1); else if(*q == 'c') pcache = 1; 
+    if((q = strchr(q, ','))) q++; 
+  }
+  if(qd < 1) qd = 1;
+    #ifndef O_DIRECT
+  pcache = 1;
+    #endif
+  if(!stat(arg, &st) && S_ISDIR(st.st_mode)) snprintf(fn, sizeof(fn), "%s/turbobench.io", arg); else snprintf(fn, sizeof(fn), "%s", arg);
+
+  for(f = 0; f < fnum; f++) if(!stat(fin[f], &st)) n += min((unsigned long long)st.st_size, filenmax);
+  unsigned char *in = (unsigned char *)_valloc(n+INOVD, 1), *out = (unsigned char *)malloc(bsize+INOVD);
+  if(!n || !in || !out) die("iobench: no input or malloc error\n");
+  for(n = f = 0; f < fnum; f++) { 
+    FILE *fi = fopen(fin[f], "rb"); if(!fi || stat(fin[f], &st)) { perror(fin[f]); if(fi) fclose(fi); continue; }
+    n += fread(in+n, 1, min((unsigned long long)st.st_size, filenmax), fi); fclose(fi); 
+  }
+  size_t nb = (n + bsize-1)/bsize, b;
+  struct ioblk *ib = (struct ioblk *)calloc(nb, sizeof(ib[0]));
+  struct aiocb *cb = (struct aiocb *)calloc(qd, sizeof(cb[0]));
+  unsigned char **slot = (unsigned char **)calloc(qd, sizeof(slot[0]));
+  if(!ib || !cb || !slot) die("malloc error\n");
+
+  printf("Storage read path '%s' %s, queue depth %d, %zu blocks of %u bytes, %lld bytes\n", fn, pcache?"page cache (dropped)":"O_DIRECT", qd, nb, bsize, n);
+  printf("      C Size  ratio%%     W MB/s     R MB/s  Disk MB/s    CPU%%   Name\n");
+  for(i = 0; i < k; i++) {
+    struct plug *p = &plug[i]; struct codprm cp; char name[65]; long long clen = 0, ofs = 0; size_t bnd = codbound(bsize, p->id), osz; int fd, e = 0, j;
+    if(p->lev >= 0) sprintf(name, "%s %d%s", p->s, p->lev, p->prm); else sprintf(name, "%s%s", p->s, p->prm);
+    osz = SIZE_ROUNDUP((bnd?bnd:(size_t)(bsize*fac)) + IOALIGN, IOALIGN);
+    unsigned char *cbuf;
+    if(posix_memalign((void **)&cbuf, IOALIGN, osz)) die("malloc error\n");
+    for(j = 0; j < qd; j++) if(posix_memalign((void **)&slot[j], IOALIGN, osz)) die("malloc error\n");
+
+    codini(n, p->id); codprmini(&cp, p->id, p->lev, p->prm);
+    if((fd = open(fn, O_CREAT|O_TRUNC|O_WRONLY, 0600)) < 0) { perror(fn); die("create error '%s'\n", fn); }
+    tm_t t0 = tmtime();
+    for(b = 0; b < nb; b++) {                               // write: compressed blocks padded to the O_DIRECT alignment
+      struct ioblk *o = &ib[b]; int l;
+      o->len = min(bsize, n - b*bsize);
+      if((l = cp.comp(in+b*bsize, o->len, cbuf, osz - IOALIGN, &cp)) <= 0) { e++; break; }
+      o->ofs = ofs; o->clen = l; o->plen = SIZE_ROUNDUP(l, IOALIGN); memset(cbuf+l, 0, o->plen - l);
+      if(write(fd, cbuf, o->plen) != o->plen) { perror(fn); die("write error '%s'\n", fn); }
+      ofs += o->plen; clen += l;
+    }
+    fsync(fd); close(fd);
+    double tw = tmtime() - t0;
+    if(e) { printf("%12s %7s %10s %10s %10s %7s   %s (compression error)\n", "", "", "", "", "", "", name); goto nxt; }
+
+    fd = -1;
+      #ifdef O_DIRECT
+    if(!pcache && (fd = open(fn, O_RDONLY|O_DIRECT)) < 0) fprintf(stderr, "O_DIRECT not supported for '%s': page cache used\n", fn);
+      #endif
+    if(fd < 0) {
+      if((fd = open(fn, O_RDONLY)) < 0) { perror(fn); die("open error '%s'\n", fn); }
+        #ifdef POSIX_FADV_DONTNEED
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        #endif
+    }
+    double c0 = cputime(); t0 = tmtime();
+    for(b = 0; b < nb + qd; b++) {                          // read: block b in slot b%qd, decompress block b-qd+1 when its read is complete
+      if(b >= qd) {
+        size_t d = b - qd; struct aiocb *c = &cb[d%qd]; const struct aiocb *cl[1] = { c };
+        while(aio_error(c) == EINPROGRESS) aio_suspend(cl, 1, NULL);
+        if(aio_return(c) < (ssize_t)ib[d].clen) e++;
+        else {
+          cp.decomp(slot[d%qd], ib[d].clen, out, ib[d].len, &cp);
+          if(memcmp(out, in+d*bsize, ib[d].len)) e++;
+        }
+      }
+      if(b < nb) {
+        struct aiocb *c = &cb[b%qd]; memset(c, 0, sizeof(c[0]));
+        c->aio_fildes = fd; c->aio_offset = ib[b].ofs; c->aio_buf = slot[b%qd]; c->aio_nbytes = ib[b].plen;
+        if(aio_read(c)) { perror("aio_read"); die("read error '%s'\n", fn); }
+      }
+    }
+    double tr = tmtime() - t0, cpu = cputime() - c0;
+    close(fd);
+    printf("%12lld %7.2f %10.2f %10.2f %10.2f %7.1f   %s%s\n", clen, (double)clen*100.0/n, TMBS(n, tw), TMBS(n, tr), TMBS(ofs, tr), tr > 0?cpu*100.0/tr:0.0, name, e?" (error)":"");
+    nxt:codexit(p->id);
+    for(j = 0; j < qd; j++) free(slot[j]);
+    free(cbuf);
+  }
+  unlink(fn);
+  free(slot); free(cb); free(ib); free(out); _vfree(in, n+INOVD);
+}
+  #else
+void iobench(char *arg, struct plug *plug, int k, char **fin, int fnum, unsigned long long filenmax, unsigned bsize) { die("--io not supported\n"); }
+  #endif
+
+//----------------------------------- Dictionary compression of small records -----------------------------------------------------
+static char *dictarg;
+
+// per record de-/compression of all records except the training sample, return time per pass in us. dict: coddict* path (reused contexts) 
+static double dictrun(struct plug *p, int dict, unsigned char *in, size_t *rofs, size_t *rlen, char *rtr, unsigned nr, unsigned char *out, size_t outsize, unsigned char *cpy, long long *clen, double *td, int *err) {
+  unsigned *olen = (unsigned *)malloc(nr*sizeof(olen[0])), i; unsigned char *op = out; double tc; struct codprm cp; 
+  if(!olen) die("malloc error\n");
+  codprmini(&cp, p->id, p->lev, p->prm);
+  TMDEF;
+  TMBEG('C', tm_repc, tm_Repc);
+  for(op = out, i = 0; i < nr; i++) 
+    if(!rtr[i]) {
+      int l = dict?coddictcomp(in+rofs[i], rlen[i], op, out+outsize-op, p->id, p->lev):cp.comp(in+rofs[i], rlen[i], op, out+outsize-op, &cp);
+      op += (olen[i] = l > 0?l:0);
+    }
+  TMEND;
+  tc = (double)tm_tm/tm_rm; *clen = op - out;
+  TMBEG('D', tm_repd, tm_Repd);
+  for(op = out, i = 0; i < nr; i++) 
+    if(!rtr[i]) { 
+      if(dict) coddictdecomp(op, olen[i], cpy+rofs[i], rlen[i], p->id, p->lev); else cp.decomp(op, olen[i], cpy+rofs[i], rlen[i], &cp);
+      op += olen[i]; 
+    }
+  TMEND;
+  *td = (double)tm_tm/tm_rm;
+  for(*err = 0, i = 0; i < nr; i++) if(!rtr[i] && (!olen[i] || memcmp(in+rofs[i], cpy+rofs[i], rlen[i]))) (*err)++;
+  free(olen);
+  return tc;
+}
+
+// arg = "size[,t#][,r#]" dictionary size, t#: % of the records for training (default 20), r#: fixed record size (default: lines or one record per file)
+void dictbench(char *arg, struct plug *plug, int k, char **fin, int fnum, unsigned long long filenmax) {
+  unsigned dsize = argtoi(arg), tpct = 20, rsize = 0, nr = 0, nt = 0, mr = 0, i; char *q = arg; long long n = 0, ntl = 0, tot = 0; struct stat st;
+  while((q = strchr(q, ','))) { q++; if(*q == 't') tpct = atoi(q+1); else if(*q == 'r') rsize = atoi(q+1); }
+  if(!dsize) dsize = 110*Kb;
+  if(tpct > 100) tpct = 100;
+  for(i = 0; i < fnum; i++) if(!stat(fin[i], &st)) n += min((unsigned long long)st.st_size, filenmax);
+  unsigned char *in = (unsigned char *)malloc(n+1), *cpy = (unsigned char *)malloc(n+1), *dict = (unsigned char *)malloc(dsize), *smp;
+  size_t *rofs = NULL, *rlen = NULL, *slen, outsize = n*fac + 10*Mb; 
+  unsigned char *out = (unsigned char *)malloc(outsize);
+  if(!in || !cpy || !dict || !out) die("malloc error\n");
+  for(n = i = 0; i < fnum; i++) {                           // records: files, lines or fixed size
+    FILE *fi = fopen(fin[i], "rb"); if(!fi || stat(fin[i], &st)) { perror(fin[i]); if(fi) fclose(fi); continue; }
+    long long l = fread(in+n, 1, min((unsigned long long)st.st_size, filenmax), fi), o = n; fclose(fi);
+    for(n += l; o < n; ) {
+      long long e = fnum > 1 && !rsize?n:(rsize?min(o+rsize, n):o+1);
+      if(!rsize && fnum == 1) { while(e < n && in[e-1] != '\n') e++; }
+      if(nr >= mr && (!(rofs = (size_t *)realloc(rofs, (mr = mr?2*mr:1024)*sizeof(rofs[0]))) || !(rlen = (size_t *)realloc(rlen, mr*sizeof(rlen[0]))))) die("malloc error\n");
+      rofs[nr] = o; rlen[nr++] = e - o; o = e;
+    }
+  }
+  if(!nr) die("dictionary: no records\n");
+  char *rtr = (char *)calloc(nr, 1);                        // training sample: t% of the records evenly spread
+  if(!rtr || !(slen = (size_t *)malloc(nr*sizeof(slen[0]))) || !(smp = (unsigned char *)malloc(n+1))) die("malloc error\n");
+  for(i = 0; i < nr; i++) 
+    if((i*tpct)%100 < tpct) { rtr[i] = tpct < 100; memcpy(smp+ntl, in+rofs[i], rlen[i]); ntl += slen[nt++] = rlen[i]; }
+  if(nt == nr) memset(rtr, 0, nr);                          // too few records: benchmark also the training sample
+  for(i = 0; i < nr; i++) if(!rtr[i]) tot += rlen[i];
+
+  printf("Dictionary: %u records avg %.0f bytes, training %u records %lld bytes, benchmark %lld bytes, dictionary max. %u bytes\n", nr, (double)n/nr, nt, ntl, tot, dsize);
+  printf("      C Size  ratio%%     C MB/s     D MB/s   Dict   Train ms  Name\n");
+  for(i = 0; i < k; i++) {
+    struct plug *p = &plug[i]; char name[65]; long long clen; double tc, td; int err; size_t dl;
+    if(p->lev >= 0) sprintf(name, "%s %d%s", p->s, p->lev, p->prm); else sprintf(name, "%s%s", p->s, p->prm);
+    codini(n, p->id);
+    int ctx = coddictini(p->id, p->lev, NULL, 0);           // w/o dictionary through the same reused contexts when available
+    tc = dictrun(p, ctx, in, rofs, rlen, rtr, nr, out, outsize, cpy, &clen, &td, &err);
+    if(ctx) coddictexit(p->id);
+    printf("%12lld %7.2f %10.2f %10.2f %6s %10s  %s%s\n", clen, (double)clen*100.0/tot, TMBS(tot, tc), TMBS(tot, td), "", "", name, err?" (error)":"");
+    tm_t t0 = tmtime();
+    if(!(dl = coddicttrain(p->id, dict, dsize, smp, slen, nt))) {  // raw prefix dictionary: the last training records
+      dl = min(dsize, ntl); memcpy(dict, smp+ntl-dl, dl);
+    }
+    double tt = tmtime() - t0;
+    if(!coddictini(p->id, p->lev, dict, dl)) { printf("%12s %7s %10s %10s %6s %10s  %s (no dictionary support)\n", "", "", "", "", "", "", name); codexit(p->id); continue; }
+    tc = dictrun(p, 1, in, rofs, rlen, rtr, nr, out, outsize, cpy, &clen, &td, &err);
+    printf("%12lld %7.2f %10.2f %10.2f %5uk %10.2f  %s +dict%s\n", clen, (double)clen*100.0/tot, TMBS(tot, tc), TMBS(tot, td), (unsigned)((dl+Kb-1)/Kb), tt/1000.0, name, err?" (error)":"");
+    coddictexit(p->id);
+    codexit(p->id);
+  }
+  free(rtr); free(slen); free(smp); free(rofs); free(rlen); free(out); free(dict); free(cpy); free(in);
+}
+
+//----------------------------------- Synthetic data: symbol sources at a target entropy, LZ workloads ----------------------------
+#define GEN_MAX 64
+static char  *genspec[GEN_MAX], *genfn[GEN_MAX];
+static double genh[GEN_MAX];                                // order-0 entropy in bits of the generated files = Shannon bound, -1:lz
+static int    gennum;
+
+static unsigned long long genrnd(unsigned long long *s) {  // splitmix64
+  unsigned long long z = (*s += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+enum { G_ZIPF, G_GEO, G_LAPLACE, G_UNIFORM, G_MIX, G_LZ, G_NUM };
+static char *gendists[] = { "zipf", "geo", "laplace", "uniform", "mix", "lz" };
+
+// probabilities of the 256 symbols. t in [0,1]: 0=uniform .. 1=single symbol, m: uniform/mix alphabet. return entropy in bits/symbol
+static double gendist(int d, double t, unsigned m, double *p) {
+  double s = 0, h = 0, w = (double)m/256 + t*(1 - (double)m/256); int i;
+  for(i = 0; i < 256; i++) {
+    switch(d) {
+      case G_ZIPF:    p[i] = pow(i+1, -t*16);                 break;
+      case G_GEO:     p[i] = pow(1-t, i);                     break;
+      case G_LAPLACE: p[i] = pow(1-t, abs((signed char)i));   break; // two sided residuals 0,1,..127,-128,..,-1 
+      case G_UNIFORM: p[i] = i < m;                           break;
+      case G_MIX:     p[i] = i < m?w/m:(1-w)/(256-m);         break; // m frequent + 256-m rare symbols
+    }
+    s += p[i];
+  }
+  for(i = 0; i < 256; i++) 
+    if((p[i] /= s) > 0) h -= p[i]*log2(p[i]);
+  return h;
+}
+
+static void genrm(void) { int g; for(g = 0; g < gennum; g++) if(genfn[g]) unlink(genfn[g]); }
+
+static unsigned gensym(unsigned long long *cum, unsigned long long *seed) { // inverse cdf sampling with the 32 bits cumulative frequencies
+  unsigned long long r = genrnd(seed) >> 32; int lo = 0, hi = 256;
+  while(hi - lo > 1) { int x = (lo+hi)/2; if(cum[x] <= r) lo = x; else hi = x; }
+  return lo;
+}
+
+static unsigned long long gengeo(double mean, unsigned long long *seed) { // geometric 0,1,2,.. with mean 
+  double u = ((genrnd(seed) >> 11) + 0.5) / 9007199254740992.0;
+  return mean > 0?(unsigned long long)(log(u) / log(mean/(mean+1))):0;
+}
+
+// LZ workload: literal runs (mean r) + matches (mean length l >= 4) at offsets log-uniform (near) or uniform (far) in the window o, 
+// p% repeat offsets (one of the last 3). overlapping matches are copied bytewise. st: literals, matches, match bytes, offset sum, repeats
+static void genlz(unsigned char *b, unsigned long long n, unsigned long long *cum, double r, double l, unsigned long long o, int far, unsigned p, 
+                  unsigned long long *seed, unsigned long long *st) {
+  unsigned long long i = 0, k, ml, ofs, rep[3] = { 1, 4, 8 }; 
+  while(i < n) {
+    for(k = gengeo(r, seed); k-- && i < n; st[0]++) 
+      b[i++] = gensym(cum, seed);
+    if(i >= n) break;
+    if(!i) { b[i++] = gensym(cum, seed); st[0]++; continue; }
+    ml = 4 + gengeo(l - 4, seed);
+    if(genrnd(seed) % 100 < p) {                            // repeat offset: rep0 50%, rep1/rep2 25%, move to front
+      unsigned j = genrnd(seed) & 3; j = j > 1?j-1:0;
+      ofs = rep[j]; for(; j; j--) rep[j] = rep[j-1]; 
+      st[4]++;
+    } else {
+      ofs = far?1 + genrnd(seed) % o:(unsigned long long)exp((double)(genrnd(seed) >> 11) / 9007199254740992.0 * log((double)o));
+      if(!ofs) ofs = 1;
+      rep[2] = rep[1]; rep[1] = rep[0];
+    }
+    if(ofs > i) ofs = i;
+    rep[0] = ofs;
+    if(ml > n-i) ml = n-i;
+    st[1]++; st[2] += ml; st[3] += ofs;
+    for(k = 0; k < ml; k++, i++) b[i] = b[i-ofs];
+  }
+}
+
+// generate into a temporary file. symbol sources: "DIST[,h#][,k#][,n#][,s#]" h:entropy bits/symbol, k:alphabet (uniform/mix), n:size, s:seed
+// LZ: "lz[,h#][,r#][,l#][,o#][,f][,p#][,n#][,s#]" h:literal entropy, r:mean literal run, l:mean match length, o:window, f:far, p:repeat offset %
+static char *genfile(int g) {
+  char *spec = genspec[g], *q = spec, *dir, fn[1024]; int d, i, far = 0, fd; double h = -1, ha, p[256], lo = 0, hi = 1, r = 8, l = 16; 
+  unsigned m = 0, c[256] = {0}, rp = 10; unsigned long long n = 16*Mb, seed = 1, cum[257], j, t, o = 64*Kb, st[5] = {0}; unsigned char *b; FILE *fo;
+  for(d = 0; d < G_NUM && strncmp(spec, gendists[d], strlen(gendists[d])); d++);
+  if(d >= G_NUM) die("--gen: unknown distribution '%s'\n", spec);
+  while((q = strchr(q, ','))) 
+    switch(*++q) {
+      case 'h': h    = atof(q+1);                  break;
+      case 'k': m    = atoi(q+1);                  break;
+      case 'n': n    = argtol(q+1);                break;
+      case 's': seed = strtoull(q+1, NULL, 10);    break;
+      case 'r': r    = atof(q+1);                  break;
+      case 'l': l    = atof(q+1);                  break;
+      case 'o': o    = argtol(q+1);                break;
+      case 'f': far  = 1;                          break;
+      case 'p': rp   = atoi(q+1);                  break;
+    }
+  if(h < 0) h = d == G_UNIFORM && m?log2(min(m, 256)):(d == G_LZ?6:4);
+  if(d == G_UNIFORM && !m) m = (unsigned)(pow(2, h) + 0.5);
+  if(d == G_MIX     && !m) m = h >= 2?1u << (int)(h-1):1;
+  m = m < 1?1:(m > 256?256:m);
+  if(l < 4) l = 4; 
+  if(!o) o = 1;
+  if(d != G_UNIFORM) 
+    for(i = 0; i < 64; i++) { double x = (lo+hi)/2; if(gendist(d == G_LZ?G_ZIPF:d, x, m, p) > h) lo = x; else hi = x; }
+  ha = gendist(d == G_LZ?G_ZIPF:d, (lo+hi)/2, m, p);
+  if(fabs(ha - h) > 0.01) 
+    die("--gen: '%s' entropy %.3f not reachable, nearest %.3f bits/symbol%s\n", spec, h, ha, d == G_MIX?" (mix: log2(k)..8)":(d == G_UNIFORM?" (uniform: log2(k))":""));
+  for(cum[0] = 0, i = 0; i < 256; i++)                      // 32 bits cumulative frequencies 
+    cum[i+1] = (unsigned long long)((double)cum[i] + p[i]*4294967296.0 + 0.5);
+  cum[256] = 1ull << 32;
+  if(!(b = (unsigned char *)malloc(n?n:1))) die("malloc error\n");
+  if(d == G_LZ) 
+    genlz(b, n, cum, r, l, o, far, rp, &seed, st);
+  else for(j = 0; j < n; j++) 
+    b[j] = gensym(cum, &seed);
+  for(j = 0; j < n; j++) c[b[j]]++;
+    #ifdef _WIN32
+  if(!(dir = getenv("TEMP"))) dir = ".";
+  snprintf(fn, sizeof(fn), "%s/tbXXXXXX", dir); _mktemp(fn); snprintf(fn+strlen(fn), sizeof(fn)-strlen(fn), "_%s", spec);
+  if((fd = open(fn, O_CREAT|O_EXCL|O_WRONLY|O_BINARY, 0600)) < 0 || !(fo = fdopen(fd, "wb"))) die("--gen: file create error '%s'\n", fn);
+    #else
+  if(!(dir = getenv("TMPDIR"))) dir = "/tmp";
+  snprintf(fn, sizeof(fn), "%s/tbXXXXXX_%s", dir, spec);   // unique name, created exclusively
+  if((fd = mkstemps(fn, strlen(spec)+1)) < 0 || !(fo = fdopen(fd, "wb"))) die("--gen: file create error '%s'\n", fn);
+    #endif
+  genfn[g] = strdup(fn);
+  if(fwrite(b, 1, n, fo) != n) die("--gen: write error '%s'\n", fn);
+  fclose(fo); free(b);
+  genh[g] = entropy(c, 256, &t);
+  if(d == G_LZ) { 
+    printf("generated '%s': lz %llu bytes, literals %.1f%% entropy %.3f bits, %llu matches avg. length %.1f offset %.0f, repeat offsets %.1f%%\n", fn, n, 
+      n?st[0]*100.0/n:0.0, ha, st[1], st[1]?(double)st[2]/st[1]:0.0, st[1]?(double)st[3]/st[1]:0.0, st[1]?st[4]*100.0/st[1]:0.0);
+    genh[g] = -1;                                           // no order-0 bound
+  } else 
+    printf("generated '%s': %s %llu symbols, target %.3f distribution %.4f sample %.4f bits/symbol\n", fn, gendists[d], n, h, ha, n?genh[g]/n:0.0);
+  return genfn[g];
+}
+
+// coder efficiency on the generated files: compressed bits / Shannon bound 
+static void geneff(struct plug *plug, int k, char **files, int nf, long long *fsize, struct fres *fr) {
+  int i, g, c;
+  for(i = 0; i < nf; i++) 
+    for(g = 0; g < gennum; g++) 
+      if(genfn[g] && genh[g] >= 0 && !strcmp(files[i], genfn[g])) {
+        printf("\n%s: %lld symbols, entropy %.4f bits/symbol, Shannon bound %.0f bytes\n", genspec[g], fsize[i], fsize[i]?genh[g]/fsize[i]:0.0, genh[g]/8);
+        printf("      C Size  bits/sym   eff.%%     C MB/s     D MB/s  Name\n");
+        for(c = 0; c < k; c++) { 
+          struct plug *p = &plug[c]; struct fres *r = &fr[(size_t)i*k+c]; char name[65];
+          if(p->lev >= 0) sprintf(name, "%s %d%s", p->s, p->lev, p->prm); else sprintf(name, "%s%s", p->s, p->prm);
+          printf("%12lld %9.4f %7.2f %10.2f %10.2f  %s\n", r->len, fsize[i]?r->len*8.0/fsize[i]:0.0, genh[g] > 0?r->len*800.0/genh[g]:0.0, 
+            TMBS(fsize[i], r->tc), TMBS(fsize[i], r->td), name);
+        }
+      }
+}
+
 void usage(char *pgm) {
   fprintf(stderr, "\nTurboBench Copyright (c) 2013-2016 Powturbo %s\n", __DATE__);
   fprintf(stderr, "Usage: %s [options] [file]\n", pgm);
   fprintf(stderr, " -eS      S = compressors/groups separated by '/' Parameter can be specified after ','\n");
+  fprintf(stderr, "          pipeline: stages separated by '+', stage level after ':' ex. -edivbwt+rans_static_o1 -esrle+lz4:9+fse -esrle:8+zstd,3,9\n");
   fprintf(stderr, " -b#s     # = blocksize (default filesize,). max=1GB\n");
   fprintf(stderr, " -B#s     # = max. benchmark filesize (default 1GB) ex. -B4G\n");
   fprintf(stderr, " -s#s     # = min. buffer size to duplicate & test small files (ex. -s50)\n");
   fprintf(stderr, "          s = modifier s:K,M,G=(1000, 1.000.000, 1.000.000.000) s:k,m,h=(1024,1Mb,1Gb). (default m) ex. 64k or 64K\n");
+  fprintf(stderr, " -F#      output buffer = filesize*# + 10MB for codecs w/o compress bound (default 1.3)\n");
+  fprintf(stderr, " -Xpath   load codec plugins (see tbplug.h) from shared object 'path' or all '*.so' in directory 'path'\n");
+  fprintf(stderr, "Files:\n");
+  fprintf(stderr, " -R       process directories recursively (default: files in the directory)\n");
+  fprintf(stderr, " -nG      G = include/exclude globs for directories separated by ',' ex. -n\"*.json,*.log,!*.tmp\"\n");
+  fprintf(stderr, " -q#      results per file in 'file.tbf' + reports per group #=1 file extension, #=2 content type (json,xml,log,text,binary,...)\n");
+  fprintf(stderr, " -d#      data characterization: entropy order 0,1,2, runs, LZ77 matches, record stride. #=1 + benchmark, #=2 only\n");
   fprintf(stderr, "Benchmark:\n");
   fprintf(stderr, " -i#/-j#  # = Minimum  de/compression iterations per run (default=auto)\n");
   fprintf(stderr, " -I#/-J#  # = Number of de/compression runs (default=3)\n");
   fprintf(stderr, " -t#      # = min. time in seconds per run.(default=2sec)\n");
   fprintf(stderr, " -S#      Sleep # min. after 2 min. processing mimizing CPU trottling\n");
   fprintf(stderr, " -k#      Repeat all benchmarks # times (default=3). -k0 = test mode\n");
+  fprintf(stderr, " -yC      recommend codec,level,blocksize with the best ratio for the constraints C (short progressive benchmark)\n");
+  fprintf(stderr, "          C = c#:min. compression MB/s, d#:min. decompression MB/s, m#s:max. memory, b#s/#s:block sizes (0=file, default 64k/1m/0)\n");
+  fprintf(stderr, "          n#:shortlist (default 5). Candidates: -e codecs or all levels of all codecs. ex. -y\"d>=1500,c>=200,m<=64M\"\n");
+  fprintf(stderr, " -zC      oracle: best -e codec per block (-b, default 1m) within the speed constraints C = c#,d# (MB/s per block, -z0: none)\n");
+  fprintf(stderr, "          ratio/speed vs. the best single codec + map of the winners per block. -v2: sizes per block\n");
+  fprintf(stderr, " --stream=I[,O][,f#] chunk sizes for the streaming API (codec parameter 's' ex. -ezlib,6,6s/zstd,3s/lz4,1s/brotli,5s/lzma,5s/bzip2,s)\n");
+  fprintf(stderr, "          I/O = input/output chunk size (default 64k,64k) f#: flush after each input chunk #=0 none #=1 sync #=2 full\n");
+  fprintf(stderr, " --dict=D[,t#][,r#] per record de-/compression w/o and with a dictionary of max. size D (ex. 64k) trained on t%% of the records\n");
+  fprintf(stderr, "          (default 20). zstd: ZDICT trainer, zlib/lz4/brotli: raw prefix. Records: lines of a file, files or r#: fixed size in bytes\n");
+  fprintf(stderr, " --gen=G  benchmark a generated input (repeatable). G = DIST[,h#][,k#][,n#][,s#] DIST: zipf,geo,laplace,uniform,mix\n");
+  fprintf(stderr, "          h#:entropy bits/symbol (default 4) k#:alphabet for uniform/mix, n#:size (default 16m) s#:seed. Reports bits / Shannon bound\n");
+  fprintf(stderr, "          G = lz[,h#][,r#][,l#][,o#][,f][,p#][,n#][,s#] LZ workload h#:literal entropy (default 6) r#:mean literal run (8)\n");
+  fprintf(stderr, "          l#:mean match length (16) o#:max. offset (64k) f:far (uniform) offsets instead of near (log-uniform) p#:%% repeat offsets (10)\n");
+  fprintf(stderr, " --io=P   storage read path: write the compressed blocks (-b, default 1m) to the scratch file P and read them back with O_DIRECT\n");
+  fprintf(stderr, "          decompressing as they arrive. P = file|dir[,q#][,c] q#:queue depth (default 4) c:page cache (dropped) instead of O_DIRECT\n");
+  fprintf(stderr, " --threads=T[,T..] decompress the independent blocks (-m or -b) with a pool of T threads, ex. --threads=1,2,4,8\n");
+  fprintf(stderr, "          T=0: 1,2,4,.. up to the number of cpus. Block index from a header scan, output at the final offsets. Speedup vs. the first T\n");
+  fprintf(stderr, " -O       subtract the harness overhead per block (measured with codec 'null') from de-/compression times\n");
   fprintf(stderr, " -K#t     Max. time limit for all benchmarks (default 24h)\n");
   fprintf(stderr, "          t = M:millisecond s:second m:minute h:hour. ex. 3h\n");
   fprintf(stderr, "Check:\n");
+  fprintf(stderr, " -cF      regression gate: compare with baseline F=file.tbb[,c%%,d%%,s%%,m%%] thresholds for compression/decompression speed,\n");
+  fprintf(stderr, "          compressed size, memory (default 5,5,0.1,10). Exit code 1 on regression. Input *.tbb: compare w/o benchmark\n");
   fprintf(stderr, " -C#      #=0 compress only, #=1 ignore errors, #=2 exit on error, #=3 crash on error\n");
+  fprintf(stderr, " --hash   verify with a 64 bits hash per 64k block computed before compression and decompress into the input buffer\n");
+  fprintf(stderr, "          (2 instead of 3 buffers: for large inputs)\n");
   fprintf(stderr, " -f#      check reading/writing outside bounds: #=1 compress, #=2 decompress, #3:both\n");
+  fprintf(stderr, "Memory:\n");
+  fprintf(stderr, " -A#      allocation profile per codec call (separate untimed pass): #=1 counts + size/lifetime histograms, #=2 + top call sites\n");
+  fprintf(stderr, " -a#      allocator for brotli,bzip2,lzma,zlib,zstd: #=0 libc, #=1 arena reset per call, #=2 size class pool, #=3 huge page arena\n");
+  fprintf(stderr, "          or per codec with parameter 'a#' ex. -ezstd,3,3a1,3a2,3a3\n");
   fprintf(stderr, "Output:\n");
   fprintf(stderr, " -v#      # = verbosity 0..3 (default 1)\n");
   fprintf(stderr, " -rstr    str = Remark/Comment string\n");
   fprintf(stderr, " -l#      # = 1 : print all groups/plugins, # = 2 : print all codecs\n");
   fprintf(stderr, " -S#      Plot transfer speed: #=1 Comp speedup #=2 Decomp speedup #=3 Comp 'MB/s' #=4 Decomp 'MB/s'\n");
+  fprintf(stderr, " -HF      transfer model for -S: F = file[,c#][,p] c#:decompression cores p:pipelined transfer+decompression ex. -Hnodes.txt,c8,p\n");
+  fprintf(stderr, "          file lines: name bandwidth(K,M,G, default MB/s) rtt_ms [concurrent_requests [overhead_us_per_request]]\n");
+  fprintf(stderr, " -DA:B    A/B report: per level deltas of codec B vs A (ex. 2 builds, see makefile tbplug_/zstd_b.so) use -k# for significance\n");
   fprintf(stderr, " -p#      #='print format' 1=text 2=html 3=htm 4=markdown 5:vBulletin 6:csv(comma) 7=tsv(tab)\n");
   fprintf(stderr, " -Q#      # Plot window 0:1920x1080, 1:1600x900, 2:1280x720, 3:800x600 (default=1)\n");
   fprintf(stderr, " -g       -g:no merge w/ old result 'file.tbb', -gg:process w/o output (use for fuzzing)\n");
   fprintf(stderr, " -o       print on standard output\n");
+  fprintf(stderr, " -w       append results with -k samples, percentiles and environment to 'file.jsonl' (JSON Lines)\n");
+  fprintf(stderr, "          *.jsonl can be used like *.tbb as input for -p# and -c\n");
+  fprintf(stderr, " -u       append results to the store '"TBS_NAME"' in the directory of the input file\n");
+  fprintf(stderr, " -xQ      query the store in directory 'file' (default current) and print reports (-p#) per dataset/host/build\n");
+  fprintf(stderr, "          Q = dataset=,codec=,level=,param=,host=,build= (all optional) ex. -x\"codec=zstd,level=3\" -v2: list all records\n");
   fprintf(stderr, " -G       plot memcpy\n");
   fprintf(stderr, " -1       Plot Speedup linear x-axis (default log)\n");
   fprintf(stderr, " -3       Plot Ratio/Speed logarithmic x-axis (default linear)\n");
@@ -1226,7 +2923,7 @@ void usage(char *pgm) {
   BEUSAGE;
   fprintf(stderr, "ex. ./turbobench enwik9 -eFAST/bzip2/lzma,5,9\n");
   fprintf(stderr, "ex. ./turbobench enwik9 -eFAST/OPTIMAL/bsc,2 -i0\n");
-  fprintf(stderr, "ex. ./turbobench eECODER -R\"entropy coder test\"\n");
+  fprintf(stderr, "ex. ./turbobench eECODER -r\"entropy coder test\"\n");
   exit(0);
 } 
 
@@ -1239,7 +2936,7 @@ void printfile(char *finame, int xstdout, int fmt, char *rem) {
   if(!k) return;
   strncpy(s, finame, 255); 
   s[255]=0;
-  if((p = strrchr(s,'.')) && !strcmp(p, ".tbb"))
+  if((p = strrchr(s,'.')) && (!strcmp(p, ".tbb") || !strcmp(p, ".jsonl")))
     *p=0;
   plugprts(plugt, k, s, xstdout, totinlen, fmt, rem);	
 } 
@@ -1253,7 +2950,7 @@ int main(int argc, char* argv[]) { //lzdbgon();
   int                recurse  = 0, xplug = 0,tm_Repk=3,plot=-1,fmt=0,fno,merge=0;
   unsigned           bsize    = 1u<<30, bsizex=0;
   unsigned long long filenmax = 0;
-  char               *scmd = NULL,*trans=NULL,*beb=NULL,*rem="",s[2049];
+  char               *scmd = NULL,*trans=NULL,*beb=NULL,*rem="",*abcmp=NULL,*basetbb=NULL,s[2049];
   char               *_argvx[1], **argvx=_argvx;
 
   int c, digit_optind = 0;
@@ -1262,17 +2959,39 @@ int main(int argc, char* argv[]) { //lzdbgon();
     int option_index = 0;
     static struct option long_options[] = {
       { "help", 	0, 0, 'h'},
+      { "io",       1, 0, 256},
+      { "stream",   1, 0, 257},
+      { "dict",     1, 0, 258},
+      { "gen",      1, 0, 259},
+      { "threads",  1, 0, 260},
+      { "hash",     0, 0, 261},
       { 0, 		    0, 0, 0}
     };
-    if((c = getopt_long(argc, argv, "1234A:b:B:C:e:E:F:f:gGi:I:j:J:k:K:l:L:mM:N:oPp:Q:rRs:S:t:T:Uv:V:W:X:Y:Z:", long_options, &option_index)) == -1) break;
+    if((c = getopt_long(argc, argv, "1234a:A:b:B:c:C:d:D:e:E:F:f:gGH:i:I:j:J:k:K:l:L:mM:n:N:oOPp:q:Q:rRs:S:t:T:uUv:V:wW:x:X:y:Y:z:Z:", long_options, &option_index)) == -1) break;
     switch(c) { 
       case 0:
         printf("Option %s", long_options[option_index].name);
         if(optarg) printf (" with arg %s", optarg);  printf ("\n");
         break;
-      case 'b': bsize    = argtoi(optarg); bsizex++; break;
+      case 'a': balloc   = atoi(optarg);      		 break;
+      case 'A': memprof  = atoi(optarg);      		 break;
+      case 'b': bsize    = argtoi(optarg); bsizex++; spbsize = bsize; break;
       case 'B': filenmax = argtol(optarg);    		 break;
+      case 'c': basetbb  = optarg;                   break;
       case 'C': cmp      = atoi(optarg);      		 break;
+      case 'd': dchar    = atoi(optarg);             break;
+      case 'y': reco     = optarg;                   break;
+      case 256: iopath   = optarg;                   break;
+      case 257: { char *q = optarg; unsigned ic = argtoi(q), oc = 0; int fl = 0;   // in[,out][,f#]
+          while((q = strchr(q, ','))) { q++; if(*q == 'f') fl = atoi(q+1); else oc = argtoi(q); }
+          codstrm(ic, oc, fl);
+        } break;
+      case 258: dictarg  = optarg;                   break;
+      case 259: if(gennum < GEN_MAX) genspec[gennum++] = optarg; break;
+      case 260: parini(optarg);                      break;
+      case 261: vhash++;                             break;
+      case 'z': orac     = optarg;                   break;
+      case 'D': abcmp    = optarg;                   break;
       case 'e': scmd     = optarg;            		 break;
       case 'F': fac      = strtod(optarg, NULL); 	 break;
       case 'f': fuzz     = atoi(optarg);       		 break;
@@ -1292,16 +3011,26 @@ int main(int argc, char* argv[]) { //lzdbgon();
  	  case 'T': tm_TX    = atoi(optarg)*TM_T; 		 break;
       case 'r': rem      = optarg;		      		 break;
       case 'S': speedup  = atoi(optarg);       		 break;
+      case 'H': bwload(optarg);                      break;
 
       case 'l': xplug    = atoi(optarg);             break;
       case 'm': mode++; 		 			 		 break;
+      case 'n': fglob    = optarg;                   break;
+      case 'q': fgrp     = atoi(optarg);             break;
+      case 'R': recurse++;                           break;
       case 'o': xstdout++; 							 break;
+      case 'O': ovhd++; 							 break;
       case 'p': fmt      = atoi(optarg);             break;
       case 'P': mcpy++;       		 			     break;	  
       case 'Q': divxy    = atoi(optarg); 
                 if(divxy>3) divxy=3;                 break;
       case 's': mininlen = argtoi(optarg);    		 break;
       case 'v': verbose  = atoi(optarg);       		 break;
+      case 'w': jsonout++;                           break;
+      case 'u': tbsout++;                            break;
+      case 'x': tbsquery = optarg;                   break;
+      case 'X': if(!plugload(optarg)) fprintf(stderr, "no codec plugin loaded from '%s'\n", optarg); 
+                break;
       case 'Y': seg_ans  = argtoi(optarg);           break;
       case 'Z': seg_huf  = argtoi(optarg);           break;  
       case '1': xlog     =  xlog?0:1; 				 break;
@@ -1324,8 +3053,10 @@ int main(int argc, char* argv[]) { //lzdbgon();
     xplug==1?plugsprt():plugsprtv(stdout, fmt); 
     exit(0); 
   }
+  if(tbsquery) 
+    exit(tbsqry(argc > optind?argv[optind]:"", tbsquery, xstdout, fmt, rem) > 0?0:1);
 
-  if(argc <= optind) {
+  if(argc <= optind && !gennum) {
       #ifdef _WIN32
     setmode( fileno(stdin), O_BINARY ); 
       #endif
@@ -1333,9 +3064,27 @@ int main(int argc, char* argv[]) { //lzdbgon();
     optind   = 0;
     argc     = 1;   
     recurse  = 0;
-  } else 
-    argvx = argv;
+  } else {                                                  // expand directories
+    for(fno = optind; fno < argc; fno++) 
+      fwalk(argv[fno], recurse, 0);
+    if(gennum) atexit(genrm);
+    for(fno = 0; fno < gennum; fno++) 
+      fladd(genfile(fno));
+    if(!fnum) die("no input files\n");
+    argvx = flist; optind = 0; argc = fnum;
+  }
 
+  if(dchar) {
+    for(fno = optind; fno < argc; fno++) 
+      datachar(argvx[fno], filenmax?filenmax:Gb);
+    if(dchar > 1) exit(0);
+  }
+  if(basetbb && argc > optind && strrchr(argvx[optind], '.') && (!strcmp(strrchr(argvx[optind], '.'), ".tbb") || !strcmp(strrchr(argvx[optind], '.'), ".jsonl"))) { // compare 2 result files
+    long long totinlen; 
+    int       k = plugread(plugt, argvx[optind], &totinlen);
+    if(k <= 0) die("file open error for '%s'\n", argvx[optind]);
+    exit(plugcmp(basetbb, plugt, k, totinlen, stdout)?1:0);
+  }
   if(fmt) {
     if(argc <= optind) { printf("no input file specified"); exit(0); }
     for(fno = optind; fno < argc; fno++)
@@ -1350,6 +3099,7 @@ int main(int argc, char* argv[]) { //lzdbgon();
   setpriority(PRIO_PROCESS, 0, -19);
 	#endif
 
+  int ecmd = scmd != NULL;
   if(!scmd) scmd = "FAST";
   for(s[0] = 0;;) {
     char *q; int i;
@@ -1370,16 +3120,46 @@ int main(int argc, char* argv[]) { //lzdbgon();
   }
 
   unsigned k = plugreg(plug, s, 0, bsize, bsizex);
+  { struct plug *p;
+    for(p = plug; p < plug+k; p++) {
+      char *q = strchr(p->prm, 'a');
+      if(!codballoc(p->id)) continue;
+      if(strchr(p->prm, 's') && (q?atoi(q+1):balloc))      // streaming api: the codec uses its own allocator
+        die("codec '%s,%d%s': custom allocator not supported with streaming 's'\n", p->s, p->lev, p->prm);
+      if(balloc && !q && strlen(p->prm) < PRMLEN-3)        // record the global allocator in the parameter
+        sprintf(p->prm+strlen(p->prm), "a%d", balloc);
+    }
+  }
   if(k > 1 && argc == 1 && !strcmp(argvx[0],"stdin")) { printf("multiple codecs not allowed when reading from stdin"); exit(0); }
 
   BEINI;
   if(!filenmax) filenmax = Gb; 
+  if(reco) {
+    recommend(reco, plug, ecmd?k:0, &argvx[optind], argc-optind, filenmax);
+    exit(0);
+  }
+  if(dictarg) {
+    dictbench(dictarg, plug, k, &argvx[optind], argc-optind, filenmax);
+    exit(0);
+  }
+  if(iopath) {
+    iobench(iopath, plug, k, &argvx[optind], argc-optind, filenmax, bsizex?bsize:Mb);
+    exit(0);
+  }
+  if(orac) {
+    oracle(orac, plug, k, &argvx[optind], argc-optind, filenmax, bsizex?bsize:Mb);
+    exit(0);
+  }
   long long totinlen = 0;  
   int       krep;
   struct    plug *p;
   char     *finame = "";
   tm_t      tmk0 = tminit();      
-  for(p = plugt; p < plugt+k; p++) p->tc = p->td = DBL_MAX; 
+  for(p = plugt; p < plugt+k; p++) p->tc = p->td = DBL_MAX, p->ks = 0; 
+  long long   *fsize = (long long *)calloc(argc, sizeof(fsize[0]));      // per file results
+  struct fres *fr    = (struct fres *)calloc((size_t)argc*k, sizeof(fr[0])); 
+  if(!fsize || !fr) die("malloc error\n");
+  if(fnum > 1) fprefetch(filenmax);
   for(krep = 0; krep < tm_Repk; krep++) { 
     if(tm_Repk > 1)
       printf("Benchmark: %d from %d\n", krep+1, tm_Repk);
@@ -1387,16 +3167,25 @@ int main(int argc, char* argv[]) { //lzdbgon();
       struct plug *g = &plugt[p-plug];
 	  totinlen = 0;  
       g->len = g->tck = g->tdk = g->memc = g->memd = 0;
+      g->rssc = g->rssd = g->pfc = g->pfd = g->pfmc = g->pfmd = 0;
       BEFILE;
       for(fno = optind; fno < argc; fno++) {
 	    finame = argvx[fno];																			if(verbose > 1) printf("%s\n", finame);	
-        totinlen += plugfile(p, finame, filenmax, bsize, plugr, tid, krep);
+        totinlen += (fsize[fno] = plugfile(p, finame, filenmax, bsize, plugr, tid, krep));
+        struct fres *r = &fr[(size_t)fno*k + (p-plug)];
+        r->len = p->len; 
+        if(!r->tc || p->tc < r->tc) r->tc = p->tc;
+        if(!r->td || p->td < r->td) r->td = p->td;
 	    g->len += p->len;
 	    g->tck += p->tc;
 	    g->tdk += p->td;
         g->err  = g->err?g->err:p->err;  								
         if(p->memc > g->memc) g->memc = p->memc;
-        if(p->memd > g->memd) g->memd = p->memd;						
+        if(p->memd > g->memd) g->memd = p->memd;
+        if(p->rssc > g->rssc) g->rssc = p->rssc;
+        if(p->rssd > g->rssd) g->rssd = p->rssd;
+        g->pfc += p->pfc; g->pfmc += p->pfmc;
+        g->pfd += p->pfd; g->pfmd += p->pfmd;
 	  }
       g->s   = p->s;
       g->lev = p->lev;
@@ -1404,10 +3193,14 @@ int main(int argc, char* argv[]) { //lzdbgon();
 	  g->id  = p->id;
       if(g->tck < g->tc) g->tc = g->tck;
       if(g->tdk < g->td) g->td = g->tdk;
+      if(g->ks < KSMAX) g->tcs[g->ks] = g->tck, g->tds[g->ks++] = g->tdk;
       if(tmtime() - tmk0 > tm_RepkT) break;
     } 
   }
     BENCHSTA;
+  if(abcmp) 
+    plugab(plugt, k, abcmp, totinlen, stdout);
+  int nreg = basetbb?plugcmp(basetbb, plugt, k, totinlen, stdout):0;
 
   if(argc - optind > 1) {
     unsigned clen = strpref(&argvx[optind], argc-optind, '\\', '/');
@@ -1427,11 +3220,25 @@ int main(int argc, char* argv[]) { //lzdbgon();
       finame = p+1;
   }
 
+  if(gennum) 
+    geneff(plug, k, argvx, argc, fsize, fr);
+  if(jsonout && merge < 2) 
+    plugjson(plugt, k, finame, totinlen);
+  if((fgrp || recurse) && merge < 2 && argc > 1) {
+    struct plug *pt = (struct plug *)malloc(k*sizeof(pt[0])); 
+    if(pt) { memcpy(pt, plugt, k*sizeof(pt[0])); plugfiles(plug, k, argvx, argc, fsize, fr, finame, fmt, rem); memcpy(plugt, pt, k*sizeof(pt[0])); free(pt); }
+  }
+  if(tbsout && merge < 2) {
+    char dir[1024], *q; 
+    strncpy(dir, argvx[optind], sizeof(dir)-1); dir[sizeof(dir)-1] = 0; 
+    if((q = strrchr(dir, '/')) || (q = strrchr(dir, '\\'))) *q = 0; else dir[0] = 0;
+    tbsadd(plugt, k, dir, finame, totinlen);
+  }
   sprintf(s, "%s.tbb", finame);
   if(merge /*|| tm_repc <= 1 || tm_repd <= 1*/) {
     if(merge == 1) 
       plugprts(plugt, k, s, 1, totinlen, FMT_TEXT, rem);	
-    exit(0);
+    exit(nreg?1:0);
   }
 
   long long _totinlen;
@@ -1447,7 +3254,7 @@ int main(int argc, char* argv[]) { //lzdbgon();
 	sprintf(tms, "%.4d-%.2d-%.2d.%.2d:%.2d:%.2d", 1900 + ltm->tm_year, ltm->tm_mon+1, ltm->tm_mday, ltm->tm_hour, ltm->tm_min, ltm->tm_sec);
 	
     struct plug *g;
-    fprintf(fo, "dataset\tsize\tcsize\tdtime\tctime\tcodec\tlevel\tparam\tcmem\tdmem\ttime\n");
+    fprintf(fo, "dataset\tsize\tcsize\tdtime\tctime\tcodec\tlevel\tparam\tcmem\tdmem\ttime\tcrss\tdrss\tcpf\tdpf\tcpfm\tdpfm\n");
     for(p = plugt; p < plugt+k; p++) {
       for(g = plug; g < plug+gk; g++) 
         if(g->id >= 0 && !strcmp(g->s, p->s) && g->lev == p->lev && !strcmp(g->prm, p->prm)) {
@@ -1465,12 +3272,15 @@ int main(int argc, char* argv[]) { //lzdbgon();
           g->id = -1;
           break; 
         }
-      fprintf(fo,   "%s\t%"PRId64"\t%"PRId64"\t%.6f\t%.6f\t%s\t%d\t%s\t%"PRId64"\t%"PRId64"\t%s\n", finame, totinlen, p->len, p->td, p->tc, p->s, p->lev, p->prm[0]?p->prm:"?", p->memc, p->memd, p->tms[0]?p->tms:tms);
+      fprintf(fo,   "%s\t%lld\t%lld\t%.6f\t%.6f\t%s\t%d\t%s\t%lld\t%lld\t%s\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\n", finame, totinlen, p->len, p->td, p->tc, p->s, p->lev, p->prm[0]?p->prm:"?", p->memc, p->memd, p->tms[0]?p->tms:tms,
+                    p->rssc, p->rssd, p->pfc, p->pfd, p->pfmc, p->pfmd);
     }
     for(g = plug; g < plug+gk; g++) 
       if(g->id >= 0)
-        fprintf(fo, "%s\t%"PRId64"\t%"PRId64"\t%.6f\t%.6f\t%s\t%d\t%s\t%"PRId64"\t%"PRId64"\t%s\n", finame, totinlen, g->len, g->td, g->tc, g->s, g->lev, g->prm[0]?g->prm:"?", g->memc, g->memd, g->tms[0]?g->tms:tms);
+        fprintf(fo, "%s\t%lld\t%lld\t%.6f\t%.6f\t%s\t%d\t%s\t%lld\t%lld\t%s\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\n", finame, totinlen, g->len, g->td, g->tc, g->s, g->lev, g->prm[0]?g->prm:"?", g->memc, g->memd, g->tms[0]?g->tms:tms,
+                    g->rssc, g->rssd, g->pfc, g->pfd, g->pfmc, g->pfmd);
     fclose(fo);
     printfile(s, 0, FMT_TEXT, rem);
   }
+  return nreg?1:0;
 }